@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QImage>
+#include <QString>
+
+// Decodes single video frames straight into memory.
+// Instances are not thread safe; use one per thread.
+class FrameGrabber {
+public:
+    virtual ~FrameGrabber() {}
+    // percent - position within the video, 0-100
+    virtual QImage grabFrame(const QString &file, int percent) = 0;
+};
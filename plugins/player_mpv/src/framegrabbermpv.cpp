@@ -0,0 +1,145 @@
+#include "framegrabbermpv.h"
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+
+FrameGrabberMpv::FrameGrabberMpv() : fileEnded(false) {
+    mpv = mpv_create();
+    if(!mpv)
+        return;
+    mpv_set_option_string(mpv, "config", "no");
+    mpv_set_option_string(mpv, "load-scripts", "no");
+    mpv_set_option_string(mpv, "terminal", "no");
+    mpv_set_option_string(mpv, "vo", "null");
+    mpv_set_option_string(mpv, "ao", "null");
+    mpv_set_option_string(mpv, "aid", "no");
+    mpv_set_option_string(mpv, "sid", "no");
+    mpv_set_option_string(mpv, "hwdec", "no");
+    mpv_set_option_string(mpv, "pause", "yes");
+    mpv_set_option_string(mpv, "idle", "yes");
+    mpv_set_option_string(mpv, "keep-open", "always");
+    // snap to the nearest keyframe instead of decoding up to the exact position
+    mpv_set_option_string(mpv, "hr-seek", "no");
+    if(mpv_initialize(mpv) < 0) {
+        qDebug() << "[FrameGrabberMpv] could not initialize mpv context";
+        mpv_terminate_destroy(mpv);
+        mpv = nullptr;
+    }
+}
+
+FrameGrabberMpv::~FrameGrabberMpv() {
+    if(mpv)
+        mpv_terminate_destroy(mpv);
+}
+
+QImage FrameGrabberMpv::grabFrame(const QString &file, int percent) {
+    QImage frame;
+    if(!mpv || file.isEmpty())
+        return frame;
+
+    QByteArray start = QByteArray::number(percent) + "%";
+    mpv_set_property_string(mpv, "start", start.constData());
+
+    QByteArray path = file.toUtf8();
+    const char *loadCmd[] = { "loadfile", path.constData(), nullptr };
+    if(mpv_command(mpv, loadCmd) < 0)
+        return frame;
+    fileEnded = false;
+
+    if(waitForFrame()) {
+        mpv_node result;
+        const char *shotCmd[] = { "screenshot-raw", "video", nullptr };
+        if(mpv_command_ret(mpv, shotCmd, &result) >= 0) {
+            frame = imageFromNode(result);
+            mpv_free_node_contents(&result);
+        }
+    }
+    unload();
+    return frame;
+}
+
+// blocks until the first frame at the start position is decoded
+bool FrameGrabberMpv::waitForFrame() {
+    QElapsedTimer t;
+    t.start();
+    while(t.elapsed() < TIMEOUT) {
+        mpv_event *event = mpv_wait_event(mpv, (TIMEOUT - t.elapsed()) / 1000.0);
+        switch(event->event_id) {
+        case MPV_EVENT_PLAYBACK_RESTART:
+            return true;
+        case MPV_EVENT_END_FILE:
+            fileEnded = true;
+            return false;
+        case MPV_EVENT_SHUTDOWN:
+            return false;
+        default:
+            break;
+        }
+    }
+    qDebug() << "[FrameGrabberMpv] timed out";
+    return false;
+}
+
+// stop playback and drain the events up to the end of this file
+// so they don't leak into the next request
+void FrameGrabberMpv::unload() {
+    const char *stopCmd[] = { "stop", nullptr };
+    mpv_command(mpv, stopCmd);
+    // a file that failed to open has already sent its END_FILE
+    if(fileEnded)
+        return;
+    QElapsedTimer t;
+    t.start();
+    while(t.elapsed() < TIMEOUT) {
+        mpv_event *event = mpv_wait_event(mpv, (TIMEOUT - t.elapsed()) / 1000.0);
+        if(event->event_id == MPV_EVENT_END_FILE ||
+           event->event_id == MPV_EVENT_SHUTDOWN ||
+           event->event_id == MPV_EVENT_NONE)
+        {
+            break;
+        }
+    }
+}
+
+QImage FrameGrabberMpv::imageFromNode(const mpv_node &node) {
+    if(node.format != MPV_FORMAT_NODE_MAP)
+        return QImage();
+    int64_t w = 0, h = 0, stride = 0;
+    QByteArray format;
+    mpv_byte_array *data = nullptr;
+    mpv_node_list *list = node.u.list;
+    for(int i = 0; i < list->num; i++) {
+        const char *key = list->keys[i];
+        const mpv_node &value = list->values[i];
+        if(!strcmp(key, "w") && value.format == MPV_FORMAT_INT64)
+            w = value.u.int64;
+        else if(!strcmp(key, "h") && value.format == MPV_FORMAT_INT64)
+            h = value.u.int64;
+        else if(!strcmp(key, "stride") && value.format == MPV_FORMAT_INT64)
+            stride = value.u.int64;
+        else if(!strcmp(key, "format") && value.format == MPV_FORMAT_STRING)
+            format = value.u.string;
+        else if(!strcmp(key, "data") && value.format == MPV_FORMAT_BYTE_ARRAY)
+            data = value.u.ba;
+    }
+    if(!data || w <= 0 || h <= 0 || stride < w * 4 || data->size < static_cast<size_t>(stride * h))
+        return QImage();
+    // bgr0 / bgra are laid out as 0xAARRGGBB on little endian
+    bool hasAlpha = (format == "bgra");
+    QImage image(static_cast<int>(w), static_cast<int>(h), hasAlpha ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    const uchar *src = static_cast<const uchar*>(data->data);
+    for(int y = 0; y < h; y++) {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        memcpy(line, src + y * stride, static_cast<size_t>(w * 4));
+        // the padding byte is not guaranteed to be 0xff
+        if(!hasAlpha) {
+            for(int x = 0; x < w; x++)
+                line[x] |= 0xff000000;
+        }
+    }
+    return image;
+}
+
+FrameGrabber *CreateFrameGrabber() {
+    return new FrameGrabberMpv();
+}
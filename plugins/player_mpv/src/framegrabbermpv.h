@@ -0,0 +1,30 @@
+#pragma once
+
+#include "framegrabber.h"
+#include <mpv/client.h>
+
+#if defined QIMGV_PLAYER_MPV_LIBRARY
+ #define TEST_COMMON_DLLSPEC Q_DECL_EXPORT
+#else
+ #define TEST_COMMON_DLLSPEC Q_DECL_IMPORT
+#endif
+
+// Headless mpv instance used for thumbnails.
+// It is kept alive between files so we only pay for the decoder setup.
+class FrameGrabberMpv : public FrameGrabber {
+public:
+    FrameGrabberMpv();
+    ~FrameGrabberMpv();
+    QImage grabFrame(const QString &file, int percent);
+
+private:
+    mpv_handle *mpv;
+    // END_FILE of the current file was already seen
+    bool fileEnded;
+    bool waitForFrame();
+    void unload();
+    QImage imageFromNode(const mpv_node &node);
+    const int TIMEOUT = 8000; // ms
+};
+
+extern "C" TEST_COMMON_DLLSPEC FrameGrabber *CreateFrameGrabber();
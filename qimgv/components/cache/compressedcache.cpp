@@ -0,0 +1,155 @@
+#include "compressedcache.h"
+
+CompressedCache::CompressedCache(QObject *parent)
+    : QObject(parent),
+      used(0),
+      budget(0),
+      jobs(0),
+      closing(false)
+{
+    readSettings();
+    connect(settings, &Settings::settingsChanged, this, &CompressedCache::readSettings);
+}
+
+// jobs still queued return right away
+CompressedCache::~CompressedCache() {
+    QMutexLocker locker(&mutex);
+    closing = true;
+    while(jobs)
+        jobsDone.wait(&mutex);
+}
+
+void CompressedCache::readSettings() {
+    QMutexLocker locker(&mutex);
+    budget = static_cast<qint64>(settings->compressedCacheSize()) * 1024 * 1024;
+    trim();
+}
+
+// only unedited static images; anything else is either cheap to load or can't be restored
+void CompressedCache::insert(std::shared_ptr<Image> img) {
+    auto imgStatic = std::dynamic_pointer_cast<ImageStatic>(img);
+    if(!imgStatic || imgStatic->isEdited())
+        return;
+    QString path = img->path();
+    QDateTime modified = img->lastModified();
+    {
+        QMutexLocker locker(&mutex);
+        if(budget <= 0 || pending.contains(path))
+            return;
+        auto it = entries.find(path);
+        if(it != entries.end() && it->modified == modified) {
+            lru.removeOne(path);
+            lru.append(path);
+            return;
+        }
+        pending.insert(path);
+        jobs++;
+    }
+    std::shared_ptr<const QImage> image = imgStatic->getImage();
+    taskScheduler->start([this, path, modified, image]() {
+        compress(path, modified, image);
+        QMutexLocker locker(&mutex);
+        jobs--;
+        jobsDone.wakeAll();
+    }, TASK_BACKGROUND);
+}
+
+// zlib at the lowest level, deflate is most of the cost even so
+void CompressedCache::compress(QString path, QDateTime modified, std::shared_ptr<const QImage> image) {
+    {
+        QMutexLocker locker(&mutex);
+        if(closing) {
+            pending.remove(path);
+            return;
+        }
+    }
+    Entry entry;
+    entry.modified = modified;
+    entry.size = image->size();
+    entry.format = image->format();
+    entry.colorTable = image->colorTable();
+    entry.bandHeight = qMax(1, BAND_BYTES / qMax(1, image->bytesPerLine()));
+    entry.bytes = 0;
+    for(int y = 0; y < image->height(); y += entry.bandHeight) {
+        int rows = qMin(entry.bandHeight, image->height() - y);
+        entry.bands.push_back(qCompress(image->constScanLine(y), rows * image->bytesPerLine(), 1));
+        entry.bytes += entry.bands.back().size();
+    }
+
+    QMutexLocker locker(&mutex);
+    pending.remove(path);
+    if(entries.contains(path)) {
+        used -= entries.value(path).bytes;
+        lru.removeOne(path);
+    }
+    entries.insert(path, entry);
+    lru.append(path);
+    used += entry.bytes;
+    trim();
+}
+
+std::shared_ptr<Image> CompressedCache::restore(QString path) {
+    Entry entry;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.find(path);
+        if(it == entries.end())
+            return nullptr;
+        // bands are implicitly shared, this doesn't copy the data
+        entry = it.value();
+        lru.removeOne(path);
+        lru.append(path);
+    }
+    std::unique_ptr<DocumentInfo> info(new DocumentInfo(path));
+    if(info->lastModified() != entry.modified) {
+        remove(path);
+        return nullptr;
+    }
+    std::unique_ptr<QImage> image(new QImage(BufferPool::image(entry.size, entry.format)));
+    if(image->isNull())
+        return nullptr;
+    image->setColorTable(entry.colorTable);
+    uchar *bits = image->bits();
+    int bytesPerLine = image->bytesPerLine();
+    bool ok = true;
+    for(size_t i = 0; i < entry.bands.size() && ok; i++) {
+        int y = static_cast<int>(i) * entry.bandHeight;
+        int rows = qMin(entry.bandHeight, entry.size.height() - y);
+        QByteArray data = qUncompress(entry.bands[i]);
+        ok = data.size() == rows * bytesPerLine;
+        if(ok)
+            memcpy(bits + static_cast<qint64>(y) * bytesPerLine, data.constData(), static_cast<size_t>(data.size()));
+    }
+    if(!ok) {
+        qDebug() << "[CompressedCache] corrupt entry:" << path;
+        remove(path);
+        return nullptr;
+    }
+    return std::shared_ptr<Image>(new ImageStatic(std::move(info), std::unique_ptr<const QImage>(image.release())));
+}
+
+bool CompressedCache::contains(QString path) {
+    QMutexLocker locker(&mutex);
+    return entries.contains(path);
+}
+
+void CompressedCache::remove(QString path) {
+    QMutexLocker locker(&mutex);
+    if(!entries.contains(path))
+        return;
+    used -= entries.take(path).bytes;
+    lru.removeOne(path);
+}
+
+void CompressedCache::clear() {
+    QMutexLocker locker(&mutex);
+    entries.clear();
+    lru.clear();
+    used = 0;
+}
+
+// expects the mutex to be locked
+void CompressedCache::trim() {
+    while(used > budget && !lru.isEmpty())
+        used -= entries.take(lru.takeFirst()).bytes;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDateTime>
+#include <vector>
+#include "sourcecontainers/imagestatic.h"
+#include "components/scheduler/taskscheduler.h"
+#include "settings.h"
+
+/* Second tier behind Cache. Images evicted from the cache are kept here
+ * compressed, so going back to one costs a decompression instead of a
+ * decode. Pixels are compressed in bands, which restore() inflates straight
+ * into the new image. Both run on the calling task's worker; spreading the
+ * bands over other threads would get around the TaskScheduler caps.
+ * Entries are checked against the file modification time on restore.
+ * Thread safe; restore() is called from the loader threads.
+ */
+
+class CompressedCache : public QObject {
+    Q_OBJECT
+public:
+    explicit CompressedCache(QObject *parent = nullptr);
+    ~CompressedCache();
+    // compresses in the background
+    void insert(std::shared_ptr<Image> img);
+    std::shared_ptr<Image> restore(QString path);
+    bool contains(QString path);
+    void remove(QString path);
+    void clear();
+
+private slots:
+    void readSettings();
+
+private:
+    struct Entry {
+        QDateTime modified;
+        QSize size;
+        QImage::Format format;
+        QVector<QRgb> colorTable;
+        int bandHeight;
+        std::vector<QByteArray> bands;
+        qint64 bytes;
+    };
+    QHash<QString, Entry> entries;
+    // least recently used first
+    QStringList lru;
+    QSet<QString> pending;
+    qint64 used, budget;
+    // background jobs of this cache, waited for on destruction
+    int jobs;
+    bool closing;
+    QMutex mutex;
+    QWaitCondition jobsDone;
+
+    void compress(QString path, QDateTime modified, std::shared_ptr<const QImage> image);
+    void trim();
+
+    const int BAND_BYTES = 1024 * 1024;
+};
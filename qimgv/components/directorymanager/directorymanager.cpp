@@ -2,13 +2,71 @@
 
 namespace fs = std::filesystem;
 
-DirectoryManager::DirectoryManager() {
+DirectoryManager::DirectoryManager()
+    : watcher(nullptr),
+      watcherPolls(false),
+      recursive(false),
+      scanGeneration(new std::atomic<uint>(0)),
+      scanning(false),
+      rescanPending(false),
+      reconciling(false),
+      snapshotDirty(false),
+      sortedMode(SortingMode::SORT_NAME),
+      sortedGeneration(0)
+{
     currentPath = "";
+    qRegisterMetaType<QVector<ScanEntry>>("QVector<ScanEntry>");
+    scanPool.setMaxThreadCount(1);
 
-    regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
     collator.setNumericMode(true);
+    connect(&sortWatcher, &QFutureWatcher<void>::finished, this, &DirectoryManager::onSortFinished);
+    connect(&snapshotWatcher, &QFutureWatcher<LoadedSnapshot>::finished, this, &DirectoryManager::onSnapshotLoaded);
 
-    watcher = DirectoryWatcher::newInstance();
+    watcherTimer.setSingleShot(true);
+    watcherTimer.setInterval(WATCHER_BATCH_INTERVAL);
+    connect(&watcherTimer, &QTimer::timeout, this, &DirectoryManager::flushWatcherEvents);
+
+    readSettings();
+    connect(settings, &Settings::settingsChanged, this, &DirectoryManager::readSettings);
+}
+
+DirectoryManager::~DirectoryManager() {
+    saveSnapshot();
+    cancelScan();
+    scanPool.waitForDone();
+    sortWatcher.waitForFinished();
+}
+
+// keys or stats are filled in by fillSortKeys() / fillStats() before sorting
+std::function<bool(quint32, quint32)> DirectoryManager::comparator(const EntryList &list, SortingMode mode) {
+    const EntryList *l = &list;
+    switch(mode) {
+    case SortingMode::SORT_NAME_DESC:
+        return [l](quint32 id1, quint32 id2) { return l->sortKeyOf(id1).compare(l->sortKeyOf(id2)) > 0; };
+    case SortingMode::SORT_TIME:
+        return [l](quint32 id1, quint32 id2) { return l->modifyTimeOf(id1) < l->modifyTimeOf(id2); };
+    case SortingMode::SORT_TIME_DESC:
+        return [l](quint32 id1, quint32 id2) { return l->modifyTimeOf(id1) > l->modifyTimeOf(id2); };
+    case SortingMode::SORT_SIZE:
+        return [l](quint32 id1, quint32 id2) { return l->sizeOf(id1) < l->sizeOf(id2); };
+    case SortingMode::SORT_SIZE_DESC:
+        return [l](quint32 id1, quint32 id2) { return l->sizeOf(id1) > l->sizeOf(id2); };
+    default:
+        return [l](quint32 id1, quint32 id2) { return l->sortKeyOf(id1).compare(l->sortKeyOf(id2)) < 0; };
+    }
+}
+
+// Network mounts get a polling watcher, everything else the native one.
+void DirectoryManager::updateWatcher(QString path) {
+    bool polling = DirectoryWatcher::isNetworkPath(path);
+    if(watcher && polling == watcherPolls)
+        return;
+    if(watcher) {
+        watcher->disconnect(this);
+        watcher->deleteWhenStopped();
+    }
+    watcherPolls = polling;
+    watcher = DirectoryWatcher::newInstance(path);
 
     connect(watcher, &DirectoryWatcher::observingStarted, this, [] () {
     //    qDebug() << "observing started";
@@ -18,72 +76,42 @@ DirectoryManager::DirectoryManager() {
     });
     connect(watcher, &DirectoryWatcher::fileCreated, this, [this] (const QString& filename) {
         //qDebug() << "[w] file created" << filename;
-        onFileAddedExternal(filename);
+        queueWatcherEvent(filename, true);
     });
     connect(watcher, &DirectoryWatcher::fileDeleted, this, [this] (const QString& filename) {
         //qDebug() << "[w] file deleted" << filename;
-        onFileRemovedExternal(filename);
+        queueWatcherEvent(filename, false);
     });
     connect(watcher, &DirectoryWatcher::fileModified, this, [this] (const QString& filename) {
         //qDebug() << "[w] file modified" << filename;
-        onFileModifiedExternal(filename);
+        queueWatcherEvent(filename, true);
     });
     connect(watcher, &DirectoryWatcher::fileRenamed, this, [this] (const QString& file1, const QString& file2) {
         //qDebug() << "[w] file renamed from" << file1 << "to" << file2;
+        // keep the event order
+        flushWatcherEvents();
         onFileRenamedExternal(file1, file2);
     });
-
-    readSettings();
-    connect(settings, &Settings::settingsChanged, this, &DirectoryManager::readSettings);
-}
-
-template< typename T, typename Pred >
-typename std::vector<T>::iterator
-insert_sorted(std::vector<T> & vec, T const& item, Pred pred) {
-    return vec.insert(std::upper_bound(vec.begin(), vec.end(), item, pred), item);
-}
-
-bool DirectoryManager::name_entry_compare(const Entry &e1, const Entry &e2) const {
-    return collator.compare(e1.path, e2.path) < 0;
-};
-
-bool DirectoryManager::name_entry_compare_reverse(const Entry &e1, const Entry &e2) const {
-    return collator.compare(e1.path, e2.path) > 0;
-};
-
-bool DirectoryManager::date_entry_compare(const Entry& e1, const Entry& e2) const {
-    return e1.modifyTime < e2.modifyTime;
-}
-
-bool DirectoryManager::date_entry_compare_reverse(const Entry& e1, const Entry& e2) const {
-    return e1.modifyTime > e2.modifyTime;
-}
-
-bool DirectoryManager::size_entry_compare(const Entry& e1, const Entry& e2) const {
-    return e1.size < e2.size;
-}
-
-bool DirectoryManager::size_entry_compare_reverse(const Entry& e1, const Entry& e2) const {
-    return e1.size > e2.size;
-}
-
-bool DirectoryManager::entryCompareString(Entry &e, QString path) {
-    return (e.path == path);
+    connect(watcher, &DirectoryWatcher::rescanNeeded, this, [this] () {
+        flushWatcherEvents();
+        startRescan();
+    });
 }
 
-CompareFunction DirectoryManager::compareFunction() {
-    CompareFunction cmpFn = &DirectoryManager::name_entry_compare;
-    if(mSortingMode == SortingMode::SORT_NAME_DESC)
-        cmpFn = &DirectoryManager::name_entry_compare_reverse;
-    if(mSortingMode == SortingMode::SORT_TIME)
-        cmpFn = &DirectoryManager::date_entry_compare;
-    if(mSortingMode == SortingMode::SORT_TIME_DESC)
-        cmpFn = &DirectoryManager::date_entry_compare_reverse;
-    if(mSortingMode == SortingMode::SORT_SIZE)
-        cmpFn = &DirectoryManager::size_entry_compare;
-    if(mSortingMode == SortingMode::SORT_SIZE_DESC)
-        cmpFn = &DirectoryManager::size_entry_compare_reverse;
-    return cmpFn;
+// stores the entry at the end, then moves it into place
+void DirectoryManager::insertSorted(QString fileName) {
+    FileStat st;
+    bool hasStat = readFileStat(toStdString(fullFilePath(fileName)), st);
+    quint32 id = entries.append(fileName, st.size, st.modifyTime, false, hasStat);
+    // entries loaded from a snapshot have no keys yet
+    if(sortsByName())
+        fillSortKeys(entries, collator.locale());
+    if(reconciling)
+        markSeen(id);
+    snapshotDirty = true;
+    auto cmp = comparator(entries, mSortingMode);
+    // the new entry itself compares as not less, so the order stays partitioned
+    entries.move(entries.count() - 1, entries.upperBound(id, cmp));
 }
 
 // ##############################################################
@@ -91,9 +119,15 @@ CompareFunction DirectoryManager::compareFunction() {
 // ##############################################################
 
 void DirectoryManager::readSettings() {
-    filterRegex = settings->supportedFormatsRegex();
-    regex.setPattern(filterRegex);
+    filter.setFormats(settings->supportedFormats());
     setSortingMode(settings->sortingMode());
+    if(recursive != settings->recursiveListing()) {
+        // the current listing is saved under the old mode
+        saveSnapshot();
+        recursive = settings->recursiveListing();
+        if(!currentPath.isEmpty())
+            setDirectory(currentPath);
+    }
 }
 
 bool DirectoryManager::setDirectory(QString path) {
@@ -108,10 +142,11 @@ bool DirectoryManager::setDirectory(QString path) {
         qDebug() << "[DirectoryManager] Error - path is not a directory.";
         return false;
     }
+    saveSnapshot();
     currentPath = path;
-    generateFileList();
-    sortFileList();
+    startScan();
     emit loaded(path);
+    updateWatcher(path);
     watcher->setWatchPath(path);
     watcher->observe();
     return true;
@@ -122,14 +157,7 @@ QString DirectoryManager::directoryPath() const {
 }
 
 int DirectoryManager::indexOf(QString fileName) const {
-    auto item = find_if(entryVec.begin(), entryVec.end(), [fileName](const Entry& e) {
-        return e.path == fileName;
-    });
-
-    if(item != entryVec.end()) {
-        return distance(entryVec.begin(), item);
-    }
-    return -1;
+    return entries.indexOf(fileName);
 }
 
 QString DirectoryManager::absolutePath() const {
@@ -137,29 +165,29 @@ QString DirectoryManager::absolutePath() const {
 }
 
 QString DirectoryManager::filePathAt(int index) const {
-    return checkRange(index) ? currentPath + "/" + entryVec.at(index).path : "";
+    return checkRange(index) ? currentPath + "/" + entries.name(index) : "";
 }
 
-// dumb. maybe better to store full paths in Entry right away
+// dumb. maybe better to store full paths in the list right away
 QString DirectoryManager::fullFilePath(QString fileName) const {
     return fileName.isEmpty() ? "" : currentPath + "/" + fileName;
 }
 
 QString DirectoryManager::fileNameAt(int index) const {
-    return checkRange(index) ? entryVec.at(index).path : "";
+    return checkRange(index) ? entries.name(index) : "";
 }
 
 QString DirectoryManager::first() {
     QString fileName = "";
-    if(entryVec.size())
-        fileName = entryVec.front().path;
+    if(!entries.isEmpty())
+        fileName = entries.name(0);
     return fileName;
 }
 
 QString DirectoryManager::last() {
     QString fileName = "";
-    if(entryVec.size())
-        fileName = entryVec.back().path;
+    if(!entries.isEmpty())
+        fileName = entries.name(entries.count() - 1);
     return fileName;
 }
 
@@ -167,15 +195,15 @@ QString DirectoryManager::prevOf(QString fileName) const {
     QString prevFileName = "";
     int currentIndex = indexOf(fileName);
     if(currentIndex > 0)
-        prevFileName = entryVec.at(currentIndex - 1).path;
+        prevFileName = entries.name(currentIndex - 1);
     return prevFileName;
 }
 
 QString DirectoryManager::nextOf(QString fileName) const {
     QString nextFileName = "";
     int currentIndex = indexOf(fileName);
-    if(currentIndex >= 0 && currentIndex < entryVec.size() - 1)
-        nextFileName = entryVec.at(currentIndex + 1).path;
+    if(currentIndex >= 0 && currentIndex < entries.count() - 1)
+        nextFileName = entries.name(currentIndex + 1);
     return nextFileName;
 }
 
@@ -183,22 +211,21 @@ bool DirectoryManager::removeFile(QString fileName, bool trash) {
     if(!contains(fileName))
         return false;
     QString path = fullFilePath(fileName);
-    QFile file(path);
-    int index = indexOf(fileName);
-    if(trash) {
-        if(moveToTrash(path)) {
-            entryVec.erase(entryVec.begin() + index);
-            emit fileRemoved(fileName, index);
-            return true;
-        }
-    } else if(file.remove()) {
-        entryVec.erase(entryVec.begin() + index);
-        emit fileRemoved(fileName, index);
-        return true;
-    }
+    if(trash ? moveToTrash(path) : QFile::remove(path))
+        return forgetFile(fileName);
     return false;
 }
 
+bool DirectoryManager::forgetFile(QString fileName) {
+    int index = indexOf(fileName);
+    if(index == -1)
+        return false;
+    entries.remove(index);
+    snapshotDirty = true;
+    emit fileRemoved(fileName, index);
+    return true;
+}
+
 #ifdef Q_OS_WIN32
 bool DirectoryManager::moveToTrash(QString file) {
     QFileInfo fileinfo( file );
@@ -283,6 +310,7 @@ bool DirectoryManager::moveToTrash(QString file) {
     QDir dir;
     if( !dir.rename( original.absoluteFilePath(), filepath ) ){
         qDebug() << "move to trash failed";
+        return false;
     }
     QFile infoFile(infopath);
     infoFile.open(QIODevice::WriteOnly | QIODevice::Text);
@@ -300,17 +328,11 @@ bool DirectoryManager::moveToTrash(QString file) {
 #endif
 
 bool DirectoryManager::checkRange(int index) const {
-    return index >= 0 && index < (int)entryVec.size();
-}
-
-bool DirectoryManager::copyTo(QString destDirectory, QString fileName) {
-    if(!contains(fileName))
-        return false;
-    return QFile::copy(fullFilePath(fileName), destDirectory + "/" + fileName);
+    return index >= 0 && index < entries.count();
 }
 
 unsigned long DirectoryManager::fileCount() const {
-    return entryVec.size();
+    return static_cast<unsigned long>(entries.count());
 }
 
 bool DirectoryManager::isDirectory(QString path) const {
@@ -325,69 +347,511 @@ QDateTime DirectoryManager::lastModified(QString fileName) const {
     return info.lastModified();
 }
 
-// TODO: what about symlinks?
+// name check first, it is much cheaper than a stat
 inline
 bool DirectoryManager::isSupportedFile(QString path) const {
-    return ( isFile(path) && regex.match(path).hasMatch() );
+    return ( filter.matches(path) && isFile(path) );
 }
 
+// follows symlinks
 inline
 bool DirectoryManager::isFile(QString path) const {
-    if(!std::filesystem::exists(toStdString(path)))
-        return false;
-    if(!std::filesystem::is_regular_file(toStdString(path)))
-        return false;
-    return true;
+    std::error_code ec;
+    return std::filesystem::is_regular_file(toStdString(path), ec);
 }
 
 bool DirectoryManager::isEmpty() const {
-    return entryVec.empty();
+    return entries.isEmpty();
 }
 
 bool DirectoryManager::contains(QString fileName) const {
-    return (std::find(entryVec.begin(), entryVec.end(), fileName) != entryVec.end());
+    return entries.contains(fileName);
 }
 
 // ##############################################################
 // ###################### PRIVATE METHODS #######################
 // ##############################################################
-void DirectoryManager::generateFileList() {
-    entryVec.clear();
-    QRegularExpressionMatch match;
-    for(const auto & entry : fs::directory_iterator(toStdString(currentPath))) {
-        QString name = QString::fromStdString(entry.path().filename().string());
-        match = regex.match(name);
-        if(match.hasMatch()) {
-            Entry newEntry;
-            try {
-                newEntry.path = name;
-                newEntry.size = entry.file_size();
-                newEntry.modifyTime = entry.last_write_time();
-                newEntry.isDirectory = entry.is_directory();
-            } catch (const std::filesystem::filesystem_error &err) {
-                qDebug() << "[DirectoryManager]" << err.what();
-                continue;
-            }
-            entryVec.emplace_back(newEntry);
-            /* It is probably worth implementing lazy loading in future.
-             * Read names only, and other stuff ondemand.
-             * This would give ~2x load speedup when we are just sorting by filename.
-             */
-            //entryVec.emplace_back(Entry(name, entry.is_directory()));
+void DirectoryManager::startScan() {
+    cancelScan();
+    // a sort of the old listing is dropped when it finishes
+    sortedList.reset();
+    sortThen = nullptr;
+    // these were for the previous directory
+    watcherTimer.stop();
+    pendingNames.clear();
+    pendingTouched.clear();
+    seenIds.clear();
+    reconcileAdded.clear();
+    reconcileModified.clear();
+    snapshotDirty = false;
+    entries.clear();
+    // the listing starts once the snapshot is in, or turns out missing
+    scanning = true;
+    loadSnapshot();
+}
+
+// Lists the directory again and applies only the differences.
+// Used when watcher events were lost.
+void DirectoryManager::startRescan() {
+    // the listing in progress may have missed something too
+    if(scanning) {
+        rescanPending = true;
+        return;
+    }
+    cancelScan();
+    // same directory, a sort in progress still applies
+    if(sortedList)
+        sortedGeneration = scanGeneration->load();
+    seenIds.clear();
+    reconcileAdded.clear();
+    reconcileModified.clear();
+    reconciling = true;
+    launchScanner(false);
+}
+
+void DirectoryManager::launchScanner(bool namesOnly) {
+    auto scanner = new DirectoryScanner(currentPath, filter, namesOnly, recursive, scanGeneration->load(), scanGeneration);
+    connect(scanner, &DirectoryScanner::batchReady, this, &DirectoryManager::onScanBatch);
+    connect(scanner, &DirectoryScanner::finished, this, &DirectoryManager::onScanFinished);
+    connect(scanner, &DirectoryScanner::statsReady, this, &DirectoryManager::onScanStats);
+    connect(scanner, &DirectoryScanner::directoriesFound, this, &DirectoryManager::onScanDirectories);
+    scanPool.start(scanner);
+}
+
+// batches of the old scan which are already queued get dropped by generation check
+void DirectoryManager::cancelScan() {
+    scanGeneration->fetch_add(1);
+    scanning = false;
+    rescanPending = false;
+    reconciling = false;
+}
+
+bool DirectoryManager::isLoading() const {
+    return scanning;
+}
+
+void DirectoryManager::onScanBatch(uint generation, QVector<ScanEntry> batch) {
+    if(generation != scanGeneration->load())
+        return;
+    if(reconciling) {
+        reconcileBatch(batch);
+        return;
+    }
+    int from = entries.count();
+    for(auto &e : batch) {
+        // could be already added by watcher or forceInsert()
+        if(!entries.contains(e.name))
+            entries.append(e.name, e.size, e.modifyTime, e.isDirectory, e.hasStat);
+    }
+    if(entries.count() > from)
+        emit filesAppended(from, entries.count() - from);
+}
+
+void DirectoryManager::onScanFinished(uint generation) {
+    if(generation != scanGeneration->load())
+        return;
+    if(reconciling) {
+        finishReconcile();
+        return;
+    }
+    // the list stays provisional until it is sorted
+    sortFileListAsync([this]() {
+        scanning = false;
+        snapshotDirty = true;
+        saveSnapshot();
+        emit listingFinished();
+        if(rescanPending) {
+            rescanPending = false;
+            startRescan();
+        }
+    });
+}
+
+void DirectoryManager::onScanDirectories(uint generation, QStringList directories) {
+    if(generation != scanGeneration->load() || !watcher)
+        return;
+    watcher->setSubdirectories(directories);
+}
+
+// Reads the saved snapshot, if there is one, and brings it into the
+// current order with the same sortList() the background sort uses.
+void DirectoryManager::loadSnapshot() {
+    QString dirPath = currentPath;
+    bool recursiveList = recursive;
+    SortingMode mode = mSortingMode;
+    QLocale locale = collator.locale();
+    uint generation = scanGeneration->load();
+    snapshotWatcher.setFuture(QtConcurrent::run(&scanPool, [dirPath, recursiveList, mode, locale, generation]() {
+        LoadedSnapshot snapshot;
+        snapshot.mode = mode;
+        snapshot.generation = generation;
+        auto list = std::make_shared<EntryList>();
+        SortingMode savedMode;
+        if(!DirectorySnapshot::load(dirPath, recursiveList, *list, savedMode, snapshot.stamp))
+            return snapshot;
+        snapshot.resorted = savedMode != mode;
+        if(snapshot.resorted)
+            sortList(*list, mode, locale, dirPath);
+        else if(isNameSort(mode))
+            fillSortKeys(*list, locale);
+        snapshot.entries = list;
+        return snapshot;
+    }));
+}
+
+// The snapshot is shown as a complete listing, then a listing with
+// stats runs to find the differences.
+void DirectoryManager::onSnapshotLoaded() {
+    LoadedSnapshot snapshot = snapshotWatcher.result();
+    if(snapshot.generation != scanGeneration->load())
+        return;
+    if(!snapshot.entries) {
+        // sizes and dates are not needed to show a list sorted by name
+        launchScanner(sortsByName());
+        return;
+    }
+    // added by forceInsert() or the watcher while the snapshot was loading
+    int from = snapshot.entries->count();
+    for(int i = 0; i < entries.count(); i++) {
+        if(!snapshot.entries->contains(entries.name(i)))
+            snapshot.entries->append(entries.name(i), entries.size(i), entries.modifyTime(i),
+                                     entries.isDirectory(i), entries.hasStat(i));
+    }
+    entries = std::move(*snapshot.entries);
+    snapshotStamp = snapshot.stamp;
+    snapshotDirty = snapshot.resorted || from < entries.count();
+    scanning = false;
+    rescanPending = false;
+    reconciling = true;
+    auto reconcile = [this]() {
+        emit listingFinished();
+        launchScanner(false);
+    };
+    // the sorting mode changed while loading
+    if(snapshot.mode != mSortingMode) {
+        sortFileListAsync(reconcile);
+        return;
+    }
+    if(from < entries.count()) {
+        if(sortsByName())
+            fillSortKeys(entries, collator.locale());
+        else
+            fillStats(entries, currentPath);
+        entries.mergeTail(from, comparator(entries, mSortingMode));
+    }
+    reconcile();
+}
+
+// Only complete listings of large directories are saved.
+// Not while a sort is running, the order wouldn't match the mode.
+void DirectoryManager::saveSnapshot() {
+    if(!snapshotDirty || scanning || reconciling || sortedList || currentPath.isEmpty())
+        return;
+    snapshotDirty = false;
+    QString dirPath = currentPath;
+    bool recursiveList = recursive;
+    if(entries.count() < DirectorySnapshot::MIN_ENTRIES) {
+        QtConcurrent::run(&scanPool, [dirPath, recursiveList]() {
+            DirectorySnapshot::remove(dirPath, recursiveList);
+        });
+        return;
+    }
+    auto list = std::make_shared<const EntryList>(entries);
+    SortingMode mode = mSortingMode;
+    QtConcurrent::run(&scanPool, [dirPath, recursiveList, list, mode]() {
+        FileStat stamp;
+        if(readFileStat(toStdString(dirPath), stamp))
+            DirectorySnapshot::save(dirPath, recursiveList, *list, mode, stamp);
+    });
+}
+
+void DirectoryManager::markSeen(quint32 id) {
+    if(id >= seenIds.size())
+        seenIds.resize(id + 1, false);
+    seenIds[id] = true;
+}
+
+bool DirectoryManager::isSeen(quint32 id) const {
+    return id < seenIds.size() && seenIds[id];
+}
+
+// New files are collected and applied at the end, so renames can be detected.
+void DirectoryManager::reconcileBatch(const QVector<ScanEntry> &batch) {
+    for(auto &e : batch) {
+        int index = entries.indexOf(e.name);
+        if(index == -1) {
+            reconcileAdded.append(e);
+            continue;
+        }
+        quint32 id = entries.idAt(index);
+        markSeen(id);
+        if(entries.hasStat(index) && entries.size(index) == e.size && entries.modifyTime(index) == e.modifyTime)
+            continue;
+        if(entries.hasStat(index))
+            reconcileModified.append(e.name);
+        entries.setStatOf(id, e.size, e.modifyTime);
+        snapshotDirty = true;
+    }
+}
+
+// Applies the differences between the snapshot and the real listing
+// through the usual change signals.
+void DirectoryManager::finishReconcile() {
+    reconciling = false;
+    // also set by watcher events and by stats filled in since the snapshot
+    bool changed = snapshotDirty || !reconcileAdded.isEmpty();
+    // a removed and an added file with the same size and date is most likely a rename
+    QHash<QPair<quint64, qint64>, int> addedByStat;
+    for(int i = 0; i < reconcileAdded.count(); i++)
+        addedByStat.insert(qMakePair(reconcileAdded[i].size, reconcileAdded[i].modifyTime), i);
+    std::vector<bool> renamed(static_cast<size_t>(reconcileAdded.count()), false);
+    QStringList unseen, removed, added, modified;
+    for(int i = 0; i < entries.count(); i++) {
+        if(!isSeen(entries.idAt(i)))
+            unseen.append(entries.name(i));
+    }
+    for(auto &fileName : unseen) {
+        changed = true;
+        int index = indexOf(fileName);
+        auto it = addedByStat.constEnd();
+        if(entries.hasStat(index))
+            it = addedByStat.constFind(qMakePair(entries.size(index), entries.modifyTime(index)));
+        if(it == addedByStat.constEnd() || renamed[it.value()] || contains(reconcileAdded[it.value()].name)) {
+            removed.append(fileName);
+            continue;
         }
+        renamed[it.value()] = true;
+        QString newName = reconcileAdded[it.value()].name;
+        entries.remove(index);
+        insertSorted(newName);
+        emit fileRenamed(fileName, index, newName, indexOf(newName));
     }
+    if(!removed.isEmpty())
+        removeEntries(removed);
+    for(int i = 0; i < reconcileAdded.count(); i++) {
+        QString fileName = reconcileAdded[i].name;
+        // could be handled by watcher in the meantime
+        if(!renamed[i] && !contains(fileName) && isFile(fullFilePath(fileName)))
+            added.append(fileName);
+    }
+    if(!added.isEmpty())
+        insertEntries(added);
+    for(auto &fileName : reconcileModified) {
+        if(contains(fileName))
+            modified.append(fileName);
+    }
+    if(!modified.isEmpty())
+        emit filesModified(modified);
+    seenIds.clear();
+    reconcileAdded.clear();
+    reconcileModified.clear();
+    FileStat current;
+    if(!changed && readFileStat(toStdString(currentPath), current) && current.modifyTime == snapshotStamp.modifyTime)
+        return;
+    snapshotDirty = true;
+    saveSnapshot();
+}
+
+void DirectoryManager::queueWatcherEvent(const QString &fileName, bool touched) {
+    pendingNames.insert(fileName);
+    if(touched)
+        pendingTouched.insert(fileName);
+    if(!watcherTimer.isActive())
+        watcherTimer.start();
+}
+
+// Events are coalesced by name; what happened to a file is decided by
+// comparing the list with what is on disk now.
+void DirectoryManager::flushWatcherEvents() {
+    watcherTimer.stop();
+    QStringList added, removed, modified;
+    for(auto &fileName : pendingNames) {
+        bool listed = contains(fileName);
+        bool exists = isSupportedFile(fullFilePath(fileName));
+        if(exists && !listed)
+            added.append(fileName);
+        else if(!exists && listed)
+            removed.append(fileName);
+        else if(exists && pendingTouched.contains(fileName))
+            modified.append(fileName);
+    }
+    pendingNames.clear();
+    pendingTouched.clear();
+    if(!removed.isEmpty())
+        removeEntries(removed);
+    if(!added.isEmpty())
+        insertEntries(added);
+    if(!modified.isEmpty())
+        updateEntries(modified);
+}
+
+// appends everything, then does a single merge into the sorted list
+void DirectoryManager::insertEntries(const QStringList &fileNames) {
+    int from = entries.count();
+    for(auto &fileName : fileNames) {
+        FileStat st;
+        bool hasStat = readFileStat(toStdString(fullFilePath(fileName)), st);
+        quint32 id = entries.append(fileName, st.size, st.modifyTime, false, hasStat);
+        if(reconciling)
+            markSeen(id);
+    }
+    if(sortsByName())
+        fillSortKeys(entries, collator.locale());
+    entries.mergeTail(from, comparator(entries, mSortingMode));
+    snapshotDirty = true;
+    emit filesAdded(fileNames);
+}
+
+void DirectoryManager::removeEntries(const QStringList &fileNames) {
+    QList<int> indexes;
+    for(auto &fileName : fileNames)
+        indexes.append(indexOf(fileName));
+    std::sort(indexes.begin(), indexes.end());
+    QStringList sortedNames;
+    for(int index : indexes)
+        sortedNames.append(entries.name(index));
+    entries.remove(indexes);
+    snapshotDirty = true;
+    emit filesRemoved(sortedNames, indexes);
+}
+
+void DirectoryManager::updateEntries(const QStringList &fileNames) {
+    for(auto &fileName : fileNames) {
+        FileStat st;
+        if(readFileStat(toStdString(fullFilePath(fileName)), st))
+            entries.setStatOf(entries.idAt(indexOf(fileName)), st.size, st.modifyTime);
+    }
+    snapshotDirty = true;
+    emit filesModified(fileNames);
+}
+
+// background stat pass for a names only listing
+void DirectoryManager::onScanStats(uint generation, QVector<ScanEntry> batch) {
+    if(generation != scanGeneration->load())
+        return;
+    for(auto &e : batch) {
+        int index = entries.indexOf(e.name);
+        // skip entries re-read by watcher or fillStats() in the meantime
+        if(index != -1 && !entries.hasStat(index))
+            entries.setStatOf(entries.idAt(index), e.size, e.modifyTime);
+    }
+}
+
+bool DirectoryManager::sortsByName() const {
+    return isNameSort(mSortingMode);
+}
+
+bool DirectoryManager::isNameSort(SortingMode mode) {
+    return mode == SortingMode::SORT_NAME || mode == SortingMode::SORT_NAME_DESC;
+}
+
+// Computes collation keys for entries which don't have one yet.
+// Each chunk gets its own QCollator, they are not safe to share between threads.
+void DirectoryManager::fillSortKeys(EntryList &list, const QLocale &locale) {
+    std::vector<quint32> ids = list.missingSortKeys();
+    if(ids.empty())
+        return;
+    const size_t chunkSize = 4096;
+    std::vector<std::pair<size_t, size_t>> chunks;
+    for(size_t i = 0; i < ids.size(); i += chunkSize)
+        chunks.push_back(std::make_pair(i, qMin(i + chunkSize, ids.size())));
+    std::vector<std::optional<QCollatorSortKey>> keys(ids.size());
+    QtConcurrent::blockingMap(chunks, [&](const std::pair<size_t, size_t> &chunk) {
+        QCollator chunkCollator(locale);
+        chunkCollator.setNumericMode(true);
+        for(size_t i = chunk.first; i < chunk.second; i++)
+            keys[i] = chunkCollator.sortKey(list.nameOf(ids[i]));
+    });
+    for(size_t i = 0; i < ids.size(); i++)
+        list.setSortKey(ids[i], *keys[i]);
+}
+
+// Reads sizes and dates the background pass did not get to yet.
+// Unreadable files are marked as done with zeroes so they are not retried.
+void DirectoryManager::fillStats(EntryList &list, const QString &dirPath) {
+    std::vector<quint32> ids = list.missingStats();
+    if(ids.empty())
+        return;
+    const size_t chunkSize = 1024;
+    std::vector<std::pair<size_t, size_t>> chunks;
+    for(size_t i = 0; i < ids.size(); i += chunkSize)
+        chunks.push_back(std::make_pair(i, qMin(i + chunkSize, ids.size())));
+    std::vector<FileStat> stats(ids.size());
+    QtConcurrent::blockingMap(chunks, [&](const std::pair<size_t, size_t> &chunk) {
+        for(size_t i = chunk.first; i < chunk.second; i++)
+            readFileStat(toStdString(dirPath + "/" + list.nameOf(ids[i])), stats[i]);
+    });
+    for(size_t i = 0; i < ids.size(); i++)
+        list.setStatOf(ids[i], stats[i].size, stats[i].modifyTime);
+}
+
+void DirectoryManager::sortList(EntryList &list, SortingMode mode, const QLocale &locale, const QString &dirPath) {
+    if(isNameSort(mode))
+        fillSortKeys(list, locale);
+    else
+        fillStats(list, dirPath);
+    list.sort(comparator(list, mode));
 }
 
 void DirectoryManager::sortFileList() {
-    sort(entryVec.begin(), entryVec.end(), std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    sortList(entries, mSortingMode, collator.locale(), currentPath);
+}
+
+// Sorts a copy of the list on the global thread pool; the keys and stats
+// it needs are computed there as well. then() runs once the result is in.
+// A newer sort replaces this one; both then()s run after it.
+void DirectoryManager::sortFileListAsync(std::function<void()> then) {
+    if(sortThen) {
+        auto previous = sortThen;
+        sortThen = [previous, then]() {
+            previous();
+            if(then)
+                then();
+        };
+    } else {
+        sortThen = then;
+    }
+    auto list = std::make_shared<EntryList>(entries);
+    SortingMode mode = mSortingMode;
+    QLocale locale = collator.locale();
+    QString dirPath = currentPath;
+    sortedList = list;
+    sortedMode = mode;
+    sortedGeneration = scanGeneration->load();
+    sortWatcher.setFuture(QtConcurrent::run([list, mode, locale, dirPath]() {
+        sortList(*list, mode, locale, dirPath);
+    }));
+}
+
+// Entries removed in the meantime are dropped from the sorted order,
+// the ones added in the meantime are merged in.
+void DirectoryManager::onSortFinished() {
+    auto list = std::move(sortedList);
+    auto then = std::move(sortThen);
+    sortedList.reset();
+    sortThen = nullptr;
+    if(!list || sortedGeneration != scanGeneration->load() || sortedMode != mSortingMode)
+        return;
+    int from = entries.adoptOrder(*list);
+    if(from < entries.count()) {
+        if(sortsByName())
+            fillSortKeys(entries, collator.locale());
+        else
+            fillStats(entries, currentPath);
+        entries.mergeTail(from, comparator(entries, mSortingMode));
+    }
+    if(then)
+        then();
 }
 
 void DirectoryManager::setSortingMode(SortingMode mode) {
     if(mode != mSortingMode) {
         mSortingMode = mode;
-        if(entryVec.size() > 1) {
-            sortFileList();
-            emit sortingChanged();
+        if(entries.count() > 1) {
+            sortFileListAsync([this]() {
+                snapshotDirty = true;
+                emit sortingChanged();
+            });
         }
     }
 }
@@ -407,7 +871,8 @@ void DirectoryManager::onFileRemovedExternal(QString fileName) {
         return;
 
     int index = indexOf(fileName);
-    entryVec.erase(entryVec.begin() + index);
+    entries.remove(index);
+    snapshotDirty = true;
     emit fileRemoved(fileName, index);
 }
 
@@ -415,11 +880,12 @@ void DirectoryManager::onFileAddedExternal(QString fileName) {
     QString fullPath = fullFilePath(fileName);
     if(!this->isSupportedFile(fullPath))
         return;
-    if(this->contains(fileName))
+    // names are unique in the list
+    if(this->contains(fileName)) {
         onFileModifiedExternal(fileName);
-    std::filesystem::directory_entry stdEntry(toStdString(fullPath));
-    Entry entry(fileName, stdEntry.file_size(), stdEntry.last_write_time(), stdEntry.is_directory());
-    insert_sorted(entryVec, entry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+        return;
+    }
+    insertSorted(fileName);
     emit fileAdded(fileName);
     return;
 }
@@ -440,27 +906,25 @@ void DirectoryManager::onFileRenamedExternal(QString oldFile, QString newFile) {
     }
     if(contains(newFile)) {
         int replaceIndex = indexOf(newFile);
-        entryVec.erase(entryVec.begin() + replaceIndex);
+        entries.remove(replaceIndex);
         emit fileRemoved(newFile, replaceIndex);
     }
     // remove the old one
     int oldIndex = indexOf(oldFile);
-    entryVec.erase(entryVec.begin() + oldIndex);
+    entries.remove(oldIndex);
     // insert
-    std::filesystem::directory_entry stdEntry(toStdString(fullPath));
-    Entry entry(newFile, stdEntry.file_size(), stdEntry.last_write_time(), stdEntry.is_directory());
-    insert_sorted(entryVec, entry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    insertSorted(newFile);
     emit fileRenamed(oldFile, oldIndex, newFile, indexOf(newFile));
 }
 
 void DirectoryManager::onFileModifiedExternal(QString fileName) {
     if(!contains(fileName))
         return;
-    QString fullPath = fullFilePath(fileName);
-    std::filesystem::directory_entry stdEntry(toStdString(fullPath));
-    int index = indexOf(fileName);
-    if(entryVec.at(index).modifyTime != stdEntry.last_write_time())
-        entryVec.at(index).modifyTime = stdEntry.last_write_time();
+    FileStat st;
+    if(readFileStat(toStdString(fullFilePath(fileName)), st)) {
+        entries.setStatOf(entries.idAt(indexOf(fileName)), st.size, st.modifyTime);
+        snapshotDirty = true;
+    }
     emit fileModified(fileName);
 }
 
@@ -468,9 +932,7 @@ bool DirectoryManager::forceInsert(QString fileName) {
     QString fullPath = fullFilePath(fileName);
     if(!this->isFile(fullPath) || contains(fileName))
         return false;
-    std::filesystem::directory_entry stdEntry(toStdString(fullPath));
-    Entry entry(fileName, stdEntry.file_size(), stdEntry.last_write_time(), stdEntry.is_directory());
-    insert_sorted(entryVec, entry, std::bind(compareFunction(), this, std::placeholders::_1, std::placeholders::_2));
+    insertSorted(fileName);
     emit fileAdded(fileName);
     return true;
 }
@@ -7,62 +7,43 @@
 #include <QSize>
 #include <QDebug>
 #include <QDateTime>
-#include <QRegularExpression>
+#include <QThreadPool>
+#include <QTimer>
+#include <QSet>
+#include <QLocale>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 
 #include <vector>
 #include <string>
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
+#include <functional>
+#include <memory>
 //#include <experimental/filesystem>
 
 #include "settings.h"
 #include "watchers/directorywatcher.h"
+#include "entrylist.h"
+#include "directoryscanner.h"
+#include "filestat.h"
+#include "filefilter.h"
+#include "directorysnapshot.h"
 #include "utils/stuff.h"
 
 #ifdef Q_OS_WIN32
 #include "windows.h"
 #endif
 
-class DirectoryManager;
-class Entry {
-public:
-    Entry() { }
-    Entry( QString _path, std::uintmax_t _size, std::filesystem::file_time_type _modifyTime, bool _isDirectory)
-        : path(_path),
-          size(_size),
-          modifyTime(_modifyTime),
-          isDirectory(_isDirectory)
-    {
-    }
-    Entry( QString _path, std::uintmax_t _size, bool _isDirectory)
-        : path(_path),
-          size(_size),
-          isDirectory(_isDirectory)
-    {
-    }
-    Entry( QString _path, bool _isDirectory)
-        : path(_path),
-          isDirectory(_isDirectory)
-    {
-    }
-    bool operator==(const QString &anotherPath) const {
-        return this->path == anotherPath;
-    }
-    QString path;
-    std::uintmax_t size;
-    std::filesystem::file_time_type modifyTime;
-    bool isDirectory;
-};
-
-typedef bool (DirectoryManager::*CompareFunction)(const Entry &e1, const Entry &e2) const;
-
 class DirectoryManager : public QObject {
     Q_OBJECT
 public:
     DirectoryManager();
-    // ignored if the same dir is already opened
+    ~DirectoryManager();
+    // starts listing in background; entries arrive via filesAppended()
     bool setDirectory(QString);
+    bool isLoading() const;
     QString directoryPath() const;
     // returns index in file list
     // -1 if not found
@@ -71,6 +52,10 @@ public:
     QString filePathAt(int index) const;
     QString fullFilePath(QString fileName) const;
     bool removeFile(QString fileName, bool trash);
+    // drops the entry of a file that was moved away by someone else
+    bool forgetFile(QString fileName);
+    // usable from any thread
+    static bool moveToTrash(QString file);
     unsigned long fileCount() const;
     bool isSupportedFile(QString filePath) const;
     bool isEmpty() const;
@@ -89,37 +74,103 @@ public:
     SortingMode sortingMode();
     bool forceInsert(QString fileName);
     bool isFile(QString path) const;
-    bool copyTo(QString destDirectory, QString fileName);
 private:
     QString currentPath;
-    QString filterRegex;
-    QRegularExpression regex;
+    FileFilter filter;
     QCollator collator;
-    std::vector<Entry> entryVec;
+    EntryList entries;
 
     DirectoryWatcher* watcher;
+    bool watcherPolls;
+    // list the whole tree below currentPath
+    bool recursive;
+    void updateWatcher(QString path);
     void readSettings();
     SortingMode mSortingMode;
-    void generateFileList();
+    QThreadPool scanPool;
+    // bumped to cancel the running scan
+    std::shared_ptr<std::atomic<uint>> scanGeneration;
+    bool scanning;
+    bool rescanPending;
+    // snapshot is shown, listing runs to find the differences
+    bool reconciling;
+    bool snapshotDirty;
+    FileStat snapshotStamp;
+    // by entry id
+    std::vector<bool> seenIds;
+    QVector<ScanEntry> reconcileAdded;
+    QStringList reconcileModified;
+    void startScan();
+    void startRescan();
+    void launchScanner(bool namesOnly);
+    void cancelScan();
+    void onScanBatch(uint generation, QVector<ScanEntry> batch);
+    void onScanFinished(uint generation);
+    void onScanStats(uint generation, QVector<ScanEntry> batch);
+    void onScanDirectories(uint generation, QStringList directories);
+    // snapshots are read, sorted and written on scanPool
+    struct LoadedSnapshot {
+        // null if there is no usable snapshot
+        std::shared_ptr<EntryList> entries;
+        SortingMode mode = SortingMode::SORT_NAME;
+        FileStat stamp;
+        bool resorted = false;
+        uint generation = 0;
+    };
+    QFutureWatcher<LoadedSnapshot> snapshotWatcher;
+    void loadSnapshot();
+    void onSnapshotLoaded();
+    void saveSnapshot();
+    void markSeen(quint32 id);
+    bool isSeen(quint32 id) const;
+    void reconcileBatch(const QVector<ScanEntry> &batch);
+    void finishReconcile();
+
+    // watcher events are applied in batches
+    QTimer watcherTimer;
+    const int WATCHER_BATCH_INTERVAL = 100; // ms
+    // touched: created or modified
+    QSet<QString> pendingNames, pendingTouched;
+    void queueWatcherEvent(const QString &fileName, bool touched);
+    void flushWatcherEvents();
+    void insertEntries(const QStringList &fileNames);
+    void removeEntries(const QStringList &fileNames);
+    void updateEntries(const QStringList &fileNames);
 
     void onFileAddedExternal(QString filename);
     void onFileRemovedExternal(QString);
     void onFileModifiedExternal(QString fileName);
     void onFileRenamedExternal(QString oldFile, QString newFile);
-    bool moveToTrash(QString file);
-    bool name_entry_compare(const Entry &e1, const Entry &e2) const;
-    bool name_entry_compare_reverse(const Entry &e1, const Entry &e2) const;
-    bool date_entry_compare(const Entry &e1, const Entry &e2) const;
-    bool date_entry_compare_reverse(const Entry &e1, const Entry &e2) const;
-    bool entryCompareString(Entry &e, QString path);
-    CompareFunction compareFunction();
-    bool size_entry_compare(const Entry &e1, const Entry &e2) const;
-    bool size_entry_compare_reverse(const Entry &e1, const Entry &e2) const;
+    void insertSorted(QString fileName);
+    bool sortsByName() const;
+    // these work on any list, the background sort uses them on a copy
+    static bool isNameSort(SortingMode mode);
+    static std::function<bool(quint32, quint32)> comparator(const EntryList &list, SortingMode mode);
+    static void fillSortKeys(EntryList &list, const QLocale &locale);
+    static void fillStats(EntryList &list, const QString &dirPath);
+    static void sortList(EntryList &list, SortingMode mode, const QLocale &locale, const QString &dirPath);
+
+    // background sort
+    QFutureWatcher<void> sortWatcher;
+    std::shared_ptr<EntryList> sortedList;
+    SortingMode sortedMode;
+    uint sortedGeneration;
+    std::function<void()> sortThen;
+    void sortFileListAsync(std::function<void()> then);
+    void onSortFinished();
 signals:
     void loaded(const QString &path);
+    // provisional listing, in directory order
+    void filesAppended(int index, int count);
+    // listing is complete and sorted
+    void listingFinished();
     void sortingChanged();
     void fileRemoved(QString, int);
     void fileModified(QString);
     void fileAdded(QString);
     void fileRenamed(QString from, int indexFrom, QString to, int indexTo);
+    // batched changes; indexes are in the list before removal, ascending
+    void filesAdded(QStringList fileNames);
+    void filesRemoved(QStringList fileNames, QList<int> indexes);
+    void filesModified(QStringList fileNames);
 };
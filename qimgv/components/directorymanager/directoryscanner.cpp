@@ -0,0 +1,234 @@
+#include "directoryscanner.h"
+#include <QThread>
+#include <thread>
+#include <chrono>
+
+namespace fs = std::filesystem;
+
+DirectoryScanner::DirectoryScanner(QString _path, FileFilter _filter, bool _namesOnly, bool _recursive, uint _generation,
+                                   std::shared_ptr<std::atomic<uint>> _currentGeneration)
+    : path(_path),
+      filter(_filter),
+      namesOnly(_namesOnly),
+      recursive(_recursive),
+      generation(_generation),
+      currentGeneration(_currentGeneration),
+      pendingDirs(0),
+      queuedDirs(0)
+{
+}
+
+bool DirectoryScanner::isCancelled() const {
+    return currentGeneration->load() != generation;
+}
+
+void DirectoryScanner::run() {
+    if(recursive) {
+        runRecursive();
+        return;
+    }
+    QVector<ScanEntry> batch;
+    int batchSize = FIRST_BATCH_SIZE;
+    QElapsedTimer t;
+    t.start();
+    std::error_code ec;
+    for(fs::directory_iterator it(toStdString(path), ec), end; !ec && it != end; it.increment(ec)) {
+        if(isCancelled())
+            return;
+        const fs::directory_entry &entry = *it;
+        // filter before converting the name
+        auto fileName = entry.path().filename().native();
+        if(!filter.matches(fileName))
+            continue;
+        // file type is cached from readdir, only symlinks get stat'ed here
+        std::error_code typeError;
+        if(!entry.is_regular_file(typeError))
+            continue;
+        ScanEntry scanEntry;
+        scanEntry.name = fromStdString(fileName);
+        scanEntry.size = 0;
+        scanEntry.modifyTime = 0;
+        scanEntry.isDirectory = false;
+        scanEntry.hasStat = false;
+        if(namesOnly) {
+            unstated.push_back(std::make_pair(entry.path(), scanEntry.name));
+        } else {
+            FileStat st;
+            if(!readFileStat(entry.path(), st))
+                continue;
+            scanEntry.size = st.size;
+            scanEntry.modifyTime = st.modifyTime;
+            scanEntry.hasStat = true;
+        }
+        batch.append(scanEntry);
+        if(batch.count() >= batchSize || t.elapsed() >= BATCH_INTERVAL) {
+            emit batchReady(generation, batch);
+            batch.clear();
+            batchSize = BATCH_SIZE;
+            t.restart();
+        }
+    }
+    if(ec)
+        qDebug() << "[DirectoryScanner]" << QString::fromStdString(ec.message());
+    if(isCancelled())
+        return;
+    if(!batch.isEmpty())
+        emit batchReady(generation, batch);
+    emit finished(generation);
+    readStats(unstated);
+}
+
+void DirectoryScanner::readStats(const UnstatedList &files) {
+    QVector<ScanEntry> batch;
+    for(auto &file : files) {
+        if(isCancelled())
+            return;
+        FileStat st;
+        if(!readFileStat(file.first, st))
+            continue;
+        ScanEntry scanEntry;
+        scanEntry.name = file.second;
+        scanEntry.size = st.size;
+        scanEntry.modifyTime = st.modifyTime;
+        scanEntry.isDirectory = false;
+        scanEntry.hasStat = true;
+        batch.append(scanEntry);
+        if(batch.count() >= BATCH_SIZE) {
+            emit statsReady(generation, batch);
+            batch.clear();
+        }
+    }
+    if(!batch.isEmpty() && !isCancelled())
+        emit statsReady(generation, batch);
+}
+
+void DirectoryScanner::runRecursive() {
+    int threadCount = qBound(1, QThread::idealThreadCount(), MAX_THREADS);
+    queues = std::vector<WorkQueue>(threadCount);
+    pendingDirs = 1;
+    queuedDirs = 1;
+    queues[0].items.push_back({ fs::path(toStdString(path)), QString() });
+    std::vector<std::thread> threads;
+    for(int i = 1; i < threadCount; i++)
+        threads.emplace_back(&DirectoryScanner::traverse, this, i);
+    traverse(0);
+    for(auto &thread : threads)
+        thread.join();
+    queues.clear();
+    if(isCancelled())
+        return;
+    emit directoriesFound(generation, directories);
+    emit finished(generation);
+    readStats(unstated);
+}
+
+// the lock makes sure a thread about to wait sees the new counter values
+void DirectoryScanner::notifyIdle(bool all) {
+    {
+        std::lock_guard<std::mutex> guard(idleLock);
+    }
+    if(all)
+        workChanged.notify_all();
+    else
+        workChanged.notify_one();
+}
+
+// own queue is used as a stack so each thread stays in one subtree;
+// thieves take from the other end, which holds the larger subtrees
+bool DirectoryScanner::takeWork(int queueIndex, WorkItem &item) {
+    int count = static_cast<int>(queues.size());
+    for(int i = 0; i < count; i++) {
+        WorkQueue &queue = queues[(queueIndex + i) % count];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if(queue.items.empty())
+            continue;
+        if(i == 0) {
+            item = std::move(queue.items.back());
+            queue.items.pop_back();
+        } else {
+            item = std::move(queue.items.front());
+            queue.items.pop_front();
+        }
+        queuedDirs--;
+        return true;
+    }
+    return false;
+}
+
+void DirectoryScanner::traverse(int queueIndex) {
+    QVector<ScanEntry> batch;
+    UnstatedList localUnstated;
+    int batchSize = FIRST_BATCH_SIZE;
+    QElapsedTimer t;
+    t.start();
+    WorkItem item;
+    while(!isCancelled()) {
+        if(!takeWork(queueIndex, item)) {
+            // queues are empty but someone may still be listing a directory
+            std::unique_lock<std::mutex> idle(idleLock);
+            // cancellation is not signalled, hence the timeout
+            workChanged.wait_for(idle, std::chrono::milliseconds(100), [this]() {
+                return queuedDirs.load() > 0 || pendingDirs.load() == 0 || isCancelled();
+            });
+            if(pendingDirs.load() == 0)
+                break;
+            continue;
+        }
+        std::error_code ec;
+        for(fs::directory_iterator it(item.path, ec), end; !ec && it != end; it.increment(ec)) {
+            if(isCancelled())
+                break;
+            const fs::directory_entry &entry = *it;
+            auto fileName = entry.path().filename().native();
+            std::error_code typeError;
+            if(!entry.is_symlink(typeError) && entry.is_directory(typeError)) {
+                QString subdir = item.prefix + fromStdString(fileName);
+                {
+                    std::lock_guard<std::mutex> guard(directoriesLock);
+                    directories.append(subdir);
+                }
+                pendingDirs++;
+                {
+                    std::lock_guard<std::mutex> guard(queues[queueIndex].lock);
+                    queues[queueIndex].items.push_back({ entry.path(), subdir + "/" });
+                    queuedDirs++;
+                }
+                notifyIdle(false);
+                continue;
+            }
+            if(!filter.matches(fileName) || !entry.is_regular_file(typeError))
+                continue;
+            ScanEntry scanEntry;
+            scanEntry.name = item.prefix + fromStdString(fileName);
+            scanEntry.size = 0;
+            scanEntry.modifyTime = 0;
+            scanEntry.isDirectory = false;
+            scanEntry.hasStat = false;
+            if(namesOnly) {
+                localUnstated.push_back(std::make_pair(entry.path(), scanEntry.name));
+            } else {
+                FileStat st;
+                if(!readFileStat(entry.path(), st))
+                    continue;
+                scanEntry.size = st.size;
+                scanEntry.modifyTime = st.modifyTime;
+                scanEntry.hasStat = true;
+            }
+            batch.append(scanEntry);
+            if(batch.count() >= batchSize || t.elapsed() >= BATCH_INTERVAL) {
+                emit batchReady(generation, batch);
+                batch.clear();
+                batchSize = BATCH_SIZE;
+                t.restart();
+            }
+        }
+        if(ec)
+            qDebug() << "[DirectoryScanner]" << QString::fromStdString(ec.message());
+        if(--pendingDirs == 0)
+            notifyIdle(true);
+    }
+    if(!batch.isEmpty() && !isCancelled())
+        emit batchReady(generation, batch);
+    std::lock_guard<std::mutex> guard(unstatedLock);
+    unstated.insert(unstated.end(), localUnstated.begin(), localUnstated.end());
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QVector>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <filesystem>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <condition_variable>
+#include "utils/stuff.h"
+#include "filestat.h"
+#include "filefilter.h"
+
+struct ScanEntry {
+    QString name;
+    quint64 size;
+    qint64 modifyTime;
+    bool isDirectory;
+    // false if size and modifyTime were not read
+    bool hasStat;
+};
+
+Q_DECLARE_METATYPE(QVector<ScanEntry>)
+
+/* Lists a directory in the background and sends the results in batches.
+ * The scan stops as soon as the shared generation counter moves past
+ * the one it was started with.
+ *
+ * In namesOnly mode files are not stat'ed during the listing; the file type
+ * comes from readdir. Sizes and modify times are read afterwards in a
+ * separate pass and sent via statsReady().
+ *
+ * In recursive mode the whole tree below path is listed by several threads,
+ * each working on its own queue of directories and stealing from the others
+ * when it runs dry. Entry names are relative to path ("2020/01/a.jpg").
+ * Directory symlinks are not followed.
+ */
+
+class DirectoryScanner : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    DirectoryScanner(QString _path, FileFilter _filter, bool _namesOnly, bool _recursive, uint _generation,
+                     std::shared_ptr<std::atomic<uint>> _currentGeneration);
+    void run();
+
+signals:
+    void batchReady(uint generation, QVector<ScanEntry> batch);
+    void finished(uint generation);
+    // namesOnly mode, after finished()
+    void statsReady(uint generation, QVector<ScanEntry> batch);
+    // recursive mode, before finished(); relative paths of all subdirectories
+    void directoriesFound(uint generation, QStringList directories);
+
+private:
+    QString path;
+    FileFilter filter;
+    bool namesOnly;
+    bool recursive;
+    uint generation;
+    std::shared_ptr<std::atomic<uint>> currentGeneration;
+
+    // first batch is small so the view fills up quickly
+    const int FIRST_BATCH_SIZE = 256;
+    const int BATCH_SIZE = 4096;
+    const int BATCH_INTERVAL = 100; // ms
+
+    const int MAX_THREADS = 8;
+
+    struct WorkItem {
+        std::filesystem::path path;
+        QString prefix; // relative to the scan root, ends with '/'
+    };
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<WorkItem> items;
+    };
+    std::vector<WorkQueue> queues;
+    // listed or being listed; queuedDirs only counts the listed ones
+    std::atomic<int> pendingDirs, queuedDirs;
+    // idle threads wait here for work or the end of the traversal
+    std::mutex idleLock;
+    std::condition_variable workChanged;
+    std::mutex directoriesLock;
+    QStringList directories;
+    // namesOnly mode, full path and entry name
+    typedef std::vector<std::pair<std::filesystem::path, QString>> UnstatedList;
+    std::mutex unstatedLock;
+    UnstatedList unstated;
+
+    bool isCancelled() const;
+    void notifyIdle(bool all);
+    void readStats(const UnstatedList &files);
+    void runRecursive();
+    void traverse(int queueIndex);
+    bool takeWork(int queueIndex, WorkItem &item);
+};
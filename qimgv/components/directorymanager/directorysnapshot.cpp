@@ -0,0 +1,84 @@
+#include "directorysnapshot.h"
+
+QString DirectorySnapshot::snapshotDir() {
+    return settings->tmpDir() + "listings/";
+}
+
+QString DirectorySnapshot::fileFor(const QString &dirPath, bool recursive) {
+    QString name(QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Md5).toHex());
+    return snapshotDir() + (recursive ? name + "-r" : name);
+}
+
+bool DirectorySnapshot::load(const QString &dirPath, bool recursive, EntryList &entries, SortingMode &mode, FileStat &stamp) {
+    QFile file(fileFor(dirPath, recursive));
+    if(!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic, version;
+    in >> magic >> version;
+    if(magic != MAGIC || version != VERSION)
+        return false;
+    QString path;
+    qint32 sortingMode, count;
+    in >> path >> stamp.modifyTime >> stamp.inode >> sortingMode >> count;
+    // a different directory now lives at this path
+    FileStat current;
+    if(path != dirPath || !readFileStat(toStdString(dirPath), current) || current.inode != stamp.inode) {
+        file.close();
+        file.remove();
+        return false;
+    }
+    if(count < 0 || sortingMode < SORT_NAME || sortingMode > SORT_TIME_DESC)
+        return false;
+    entries.clear();
+    entries.reserve(count);
+    QString name;
+    quint64 size;
+    qint64 modifyTime;
+    bool isDirectory, hasStat;
+    for(qint32 i = 0; i < count; i++) {
+        in >> name >> size >> modifyTime >> isDirectory >> hasStat;
+        if(in.status() != QDataStream::Ok)
+            break;
+        entries.append(name, size, modifyTime, isDirectory, hasStat);
+    }
+    if(in.status() != QDataStream::Ok) {
+        qDebug() << "[DirectorySnapshot] Corrupted snapshot for" << dirPath;
+        entries.clear();
+        return false;
+    }
+    mode = static_cast<SortingMode>(sortingMode);
+    return true;
+}
+
+bool DirectorySnapshot::save(const QString &dirPath, bool recursive, const EntryList &entries, SortingMode mode, const FileStat &stamp) {
+    QDir().mkpath(snapshotDir());
+    QFile file(fileFor(dirPath, recursive));
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << MAGIC << VERSION;
+    out << dirPath << stamp.modifyTime << stamp.inode << static_cast<qint32>(mode) << static_cast<qint32>(entries.count());
+    for(int i = 0; i < entries.count(); i++)
+        out << entries.name(i) << entries.size(i) << entries.modifyTime(i) << entries.isDirectory(i) << entries.hasStat(i);
+    file.close();
+    if(out.status() != QDataStream::Ok) {
+        file.remove();
+        return false;
+    }
+    prune();
+    return true;
+}
+
+void DirectorySnapshot::remove(const QString &dirPath, bool recursive) {
+    QFile::remove(fileFor(dirPath, recursive));
+}
+
+// keeps the most recently written ones
+void DirectorySnapshot::prune() {
+    QFileInfoList files = QDir(snapshotDir()).entryInfoList(QDir::Files, QDir::Time);
+    for(int i = MAX_SNAPSHOTS; i < files.count(); i++)
+        QFile::remove(files.at(i).absoluteFilePath());
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+#include <QFile>
+#include <QDir>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QDebug>
+#include "settings.h"
+#include "entrylist.h"
+#include "filestat.h"
+#include "utils/stuff.h"
+
+/* Saved listings of large directories.
+ *
+ * A snapshot holds the entries in their sorted order, the sorting mode and
+ * the directory's mtime / inode at the time of saving. Collation keys can't
+ * be serialized, so the stored order is what saves the sort on reopen.
+ * A snapshot is only a starting point: the caller is expected to reconcile
+ * it against the real listing.
+ * Recursive listings of a directory are kept apart from the flat ones.
+ */
+
+class DirectorySnapshot {
+public:
+    // directories smaller than this are listed fast enough as is
+    static constexpr int MIN_ENTRIES = 2000;
+
+    // fills entries if there is a usable snapshot for dirPath
+    static bool load(const QString &dirPath, bool recursive, EntryList &entries, SortingMode &mode, FileStat &stamp);
+    static bool save(const QString &dirPath, bool recursive, const EntryList &entries, SortingMode mode, const FileStat &stamp);
+    static void remove(const QString &dirPath, bool recursive);
+
+private:
+    static constexpr quint32 MAGIC = 0x716c7374;
+    static constexpr quint32 VERSION = 1;
+    static constexpr int MAX_SNAPSHOTS = 20;
+
+    static QString snapshotDir();
+    static QString fileFor(const QString &dirPath, bool recursive);
+    static void prune();
+};
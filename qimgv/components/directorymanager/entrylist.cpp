@@ -0,0 +1,363 @@
+#include "entrylist.h"
+
+EntryList::EntryList() : garbage(0) {
+}
+
+int EntryList::count() const {
+    return static_cast<int>(order.size());
+}
+
+bool EntryList::isEmpty() const {
+    return order.empty();
+}
+
+void EntryList::clear() {
+    names.clear();
+    records.clear();
+    sizes.clear();
+    modifyTimes.clear();
+    sortKeys.clear();
+    freeIds.clear();
+    order.clear();
+    positions.clear();
+    buckets.clear();
+    garbage = 0;
+}
+
+void EntryList::reserve(int size) {
+    if(size <= 0)
+        return;
+    records.reserve(size);
+    sizes.reserve(size);
+    modifyTimes.reserve(size);
+    sortKeys.reserve(size);
+    order.reserve(size);
+    positions.reserve(size);
+    // average file name is around 20 characters
+    names.reserve(static_cast<size_t>(size) * 20);
+    size_t bucketCount = 16;
+    while(bucketCount < static_cast<size_t>(size) * 2)
+        bucketCount *= 2;
+    if(bucketCount > buckets.size())
+        rehash(bucketCount);
+}
+
+quint32 EntryList::append(const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat) {
+    quint32 id = store(name, size, modifyTime, isDirectory, hasStat);
+    positions[id] = static_cast<quint32>(order.size());
+    order.push_back(id);
+    return id;
+}
+
+quint32 EntryList::insert(int index, const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat) {
+    index = qBound(0, index, count());
+    quint32 id = store(name, size, modifyTime, isDirectory, hasStat);
+    order.insert(order.begin() + index, id);
+    updatePositions(index);
+    return id;
+}
+
+void EntryList::remove(int index) {
+    if(index < 0 || index >= count())
+        return;
+    quint32 id = order[index];
+    order.erase(order.begin() + index);
+    release(id);
+    updatePositions(index);
+}
+
+void EntryList::remove(const QList<int> &indexes) {
+    int first = count();
+    for(int index : indexes) {
+        if(index < 0 || index >= count() || !records[order[index]].alive)
+            continue;
+        release(order[index]);
+        first = qMin(first, index);
+    }
+    if(first == count())
+        return;
+    order.erase(std::remove_if(order.begin() + first, order.end(), [this](quint32 id) {
+        return !records[id].alive;
+    }), order.end());
+    updatePositions(first);
+}
+
+void EntryList::move(int from, int to) {
+    if(from == to || from < 0 || from >= count())
+        return;
+    to = qBound(0, to, count() - 1);
+    quint32 id = order[from];
+    order.erase(order.begin() + from);
+    order.insert(order.begin() + to, id);
+    updatePositions(qMin(from, to));
+}
+
+int EntryList::adoptOrder(const EntryList &sorted) {
+    std::vector<quint32> newOrder;
+    newOrder.reserve(order.size());
+    std::vector<bool> taken(records.size(), false);
+    for(quint32 id : sorted.order) {
+        // ids can be reused, check that it is still the same file
+        if(id >= records.size() || !records[id].alive || taken[id])
+            continue;
+        const Record &r = sorted.records[id];
+        if(!nameEquals(id, sorted.names.data() + r.nameOffset, r.nameLength))
+            continue;
+        if(!records[id].hasStat && r.hasStat) {
+            sizes[id] = sorted.sizes[id];
+            modifyTimes[id] = sorted.modifyTimes[id];
+            records[id].hasStat = true;
+        }
+        if(!sortKeys[id] && sorted.sortKeys[id])
+            sortKeys[id] = sorted.sortKeys[id];
+        taken[id] = true;
+        newOrder.push_back(id);
+    }
+    int sortedCount = static_cast<int>(newOrder.size());
+    for(quint32 id : order)
+        if(!taken[id])
+            newOrder.push_back(id);
+    order.swap(newOrder);
+    updatePositions(0);
+    return sortedCount;
+}
+
+int EntryList::indexOf(const QString &name) const {
+    size_t bucket = findBucket(name.constData(), name.length());
+    if(bucket == buckets.size())
+        return -1;
+    return static_cast<int>(positions[buckets[bucket] - 1]);
+}
+
+bool EntryList::contains(const QString &name) const {
+    return findBucket(name.constData(), name.length()) != buckets.size();
+}
+
+QString EntryList::name(int index) const {
+    return nameOf(order[index]);
+}
+
+quint64 EntryList::size(int index) const {
+    return sizes[order[index]];
+}
+
+qint64 EntryList::modifyTime(int index) const {
+    return modifyTimes[order[index]];
+}
+
+bool EntryList::isDirectory(int index) const {
+    return records[order[index]].isDirectory;
+}
+
+void EntryList::setModifyTime(int index, qint64 time) {
+    modifyTimes[order[index]] = time;
+}
+
+void EntryList::setSize(int index, quint64 size) {
+    sizes[order[index]] = size;
+}
+
+quint32 EntryList::idAt(int index) const {
+    return order[index];
+}
+
+int EntryList::indexOfId(quint32 id) const {
+    return static_cast<int>(positions[id]);
+}
+
+QString EntryList::nameOf(quint32 id) const {
+    const Record &r = records[id];
+    return QString(names.data() + r.nameOffset, r.nameLength);
+}
+
+quint64 EntryList::sizeOf(quint32 id) const {
+    return sizes[id];
+}
+
+qint64 EntryList::modifyTimeOf(quint32 id) const {
+    return modifyTimes[id];
+}
+
+bool EntryList::hasStat(int index) const {
+    return records[order[index]].hasStat;
+}
+
+bool EntryList::hasStatOf(quint32 id) const {
+    return records[id].hasStat;
+}
+
+void EntryList::setStatOf(quint32 id, quint64 size, qint64 modifyTime) {
+    sizes[id] = size;
+    modifyTimes[id] = modifyTime;
+    records[id].hasStat = true;
+}
+
+std::vector<quint32> EntryList::missingStats() const {
+    std::vector<quint32> ids;
+    for(quint32 id : order) {
+        if(!records[id].hasStat)
+            ids.push_back(id);
+    }
+    return ids;
+}
+
+bool EntryList::hasSortKey(quint32 id) const {
+    return sortKeys[id].has_value();
+}
+
+const QCollatorSortKey &EntryList::sortKeyOf(quint32 id) const {
+    return *sortKeys[id];
+}
+
+void EntryList::setSortKey(quint32 id, const QCollatorSortKey &key) {
+    sortKeys[id] = key;
+}
+
+std::vector<quint32> EntryList::missingSortKeys() const {
+    std::vector<quint32> ids;
+    for(quint32 id : order) {
+        if(!sortKeys[id])
+            ids.push_back(id);
+    }
+    return ids;
+}
+
+// ------------------------------------------------------------------ storage
+
+quint32 EntryList::store(const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat) {
+    Record r;
+    r.nameOffset = static_cast<quint32>(names.size());
+    r.nameLength = static_cast<quint16>(qMin(name.length(), 0xffff));
+    r.hash = hashOf(name.constData(), r.nameLength);
+    r.isDirectory = isDirectory;
+    r.hasStat = hasStat;
+    r.alive = true;
+    names.insert(names.end(), name.constData(), name.constData() + r.nameLength);
+
+    quint32 id;
+    if(!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+        records[id] = r;
+        sizes[id] = size;
+        modifyTimes[id] = modifyTime;
+        sortKeys[id].reset();
+    } else {
+        id = static_cast<quint32>(records.size());
+        records.push_back(r);
+        sizes.push_back(size);
+        modifyTimes.push_back(modifyTime);
+        sortKeys.emplace_back();
+        positions.push_back(0);
+    }
+    hashInsert(id);
+    return id;
+}
+
+void EntryList::release(quint32 id) {
+    hashRemove(id);
+    records[id].alive = false;
+    sortKeys[id].reset();
+    garbage += records[id].nameLength;
+    freeIds.push_back(id);
+    // don't let removed names pile up in the arena
+    if(garbage > 4096 && garbage > names.size() / 2)
+        compactNames();
+}
+
+void EntryList::updatePositions(int from) {
+    for(size_t i = static_cast<size_t>(from); i < order.size(); i++)
+        positions[order[i]] = static_cast<quint32>(i);
+}
+
+void EntryList::compactNames() {
+    std::vector<QChar> compacted;
+    compacted.reserve(names.size() - garbage);
+    for(auto &r : records) {
+        if(!r.alive)
+            continue;
+        quint32 offset = static_cast<quint32>(compacted.size());
+        compacted.insert(compacted.end(), names.begin() + r.nameOffset, names.begin() + r.nameOffset + r.nameLength);
+        r.nameOffset = offset;
+    }
+    names.swap(compacted);
+    garbage = 0;
+}
+
+// --------------------------------------------------------------- hash table
+
+quint32 EntryList::hashOf(const QChar *data, int length) {
+    return qHashBits(data, static_cast<size_t>(length) * sizeof(QChar), 0);
+}
+
+bool EntryList::nameEquals(quint32 id, const QChar *data, int length) const {
+    const Record &r = records[id];
+    return r.nameLength == length &&
+           std::memcmp(names.data() + r.nameOffset, data, static_cast<size_t>(length) * sizeof(QChar)) == 0;
+}
+
+// returns buckets.size() if not found
+size_t EntryList::findBucket(const QChar *data, int length) const {
+    if(buckets.empty())
+        return buckets.size();
+    const size_t mask = buckets.size() - 1;
+    quint32 hash = hashOf(data, length);
+    for(size_t i = hash & mask; buckets[i] != EMPTY; i = (i + 1) & mask) {
+        quint32 id = buckets[i] - 1;
+        if(records[id].hash == hash && nameEquals(id, data, length))
+            return i;
+    }
+    return buckets.size();
+}
+
+void EntryList::hashInsert(quint32 id) {
+    // keep load factor under 0.5
+    size_t used = records.size() - freeIds.size();
+    if(used * 2 > buckets.size()) {
+        // places the new entry too
+        rehash(qMax<size_t>(16, buckets.size() * 2));
+        return;
+    }
+    const size_t mask = buckets.size() - 1;
+    size_t i = records[id].hash & mask;
+    while(buckets[i] != EMPTY)
+        i = (i + 1) & mask;
+    buckets[i] = id + 1;
+}
+
+// backward shift deletion, no tombstones
+void EntryList::hashRemove(quint32 id) {
+    if(buckets.empty())
+        return;
+    const size_t mask = buckets.size() - 1;
+    size_t i = records[id].hash & mask;
+    while(buckets[i] != id + 1) {
+        if(buckets[i] == EMPTY)
+            return;
+        i = (i + 1) & mask;
+    }
+    buckets[i] = EMPTY;
+    for(size_t j = (i + 1) & mask; buckets[j] != EMPTY; j = (j + 1) & mask) {
+        size_t home = records[buckets[j] - 1].hash & mask;
+        // move back unless the entry's home slot lies cyclically in (i, j]
+        bool stays = (i <= j) ? (home > i && home <= j) : (home > i || home <= j);
+        if(!stays) {
+            buckets[i] = buckets[j];
+            buckets[j] = EMPTY;
+            i = j;
+        }
+    }
+}
+
+void EntryList::rehash(size_t bucketCount) {
+    buckets.assign(bucketCount, EMPTY);
+    const size_t mask = bucketCount - 1;
+    for(quint32 id = 0; id < records.size(); id++) {
+        if(!records[id].alive)
+            continue;
+        size_t i = records[id].hash & mask;
+        while(buckets[i] != EMPTY)
+            i = (i + 1) & mask;
+        buckets[i] = id + 1;
+    }
+}
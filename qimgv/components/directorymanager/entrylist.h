@@ -0,0 +1,170 @@
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QHashFunctions>
+#include <QCollator>
+#include <QThread>
+#include <QtConcurrent>
+#include <vector>
+#include <array>
+#include <optional>
+#include <algorithm>
+#include <cstring>
+
+// Sorts chunks on the global thread pool, then merges them pairwise.
+// Small inputs are sorted in place on the calling thread.
+template<typename T, typename Compare>
+void parallelSort(std::vector<T> &vec, Compare cmp) {
+    const size_t minChunk = 8192;
+    size_t chunks = qMin<size_t>(static_cast<size_t>(qMax(QThread::idealThreadCount(), 1)), vec.size() / minChunk);
+    if(chunks < 2) {
+        std::sort(vec.begin(), vec.end(), cmp);
+        return;
+    }
+    typedef std::pair<size_t, size_t> Range;
+    std::vector<Range> ranges;
+    for(size_t i = 0; i < chunks; i++)
+        ranges.push_back(Range(vec.size() * i / chunks, vec.size() * (i + 1) / chunks));
+    QtConcurrent::blockingMap(ranges, [&vec, &cmp](const Range &r) {
+        std::sort(vec.begin() + r.first, vec.begin() + r.second, cmp);
+    });
+    while(ranges.size() > 1) {
+        std::vector<std::array<size_t, 3>> merges;
+        std::vector<Range> merged;
+        for(size_t i = 0; i + 1 < ranges.size(); i += 2) {
+            merges.push_back({ ranges[i].first, ranges[i].second, ranges[i + 1].second });
+            merged.push_back(Range(ranges[i].first, ranges[i + 1].second));
+        }
+        if(ranges.size() % 2)
+            merged.push_back(ranges.back());
+        QtConcurrent::blockingMap(merges, [&vec, &cmp](const std::array<size_t, 3> &m) {
+            std::inplace_merge(vec.begin() + m[0], vec.begin() + m[1], vec.begin() + m[2], cmp);
+        });
+        ranges.swap(merged);
+    }
+}
+
+/* Compact storage for directory entries.
+ *
+ * Names live in a single UTF-16 arena, metadata in packed arrays indexed by
+ * entry id. Ids are stable for the lifetime of an entry; the listing order
+ * is a separate id vector, so sorting only moves 4 byte ids around.
+ * An open addressing table over the arena gives O(1) name -> index lookups.
+ */
+
+class EntryList {
+public:
+    EntryList();
+
+    int count() const;
+    bool isEmpty() const;
+    void clear();
+    void reserve(int size);
+
+    // adds an entry at the end of current order
+    // returns its id
+    // pass hasStat = false if size and modifyTime are not known yet
+    quint32 append(const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat = true);
+    quint32 insert(int index, const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat = true);
+    void remove(int index);
+    // removes several entries in one pass, indexes in any order
+    void remove(const QList<int> &indexes);
+
+    // -1 if not found
+    int indexOf(const QString &name) const;
+    bool contains(const QString &name) const;
+
+    QString name(int index) const;
+    quint64 size(int index) const;
+    qint64 modifyTime(int index) const;
+    bool isDirectory(int index) const;
+    void setModifyTime(int index, qint64 time);
+    void setSize(int index, quint64 size);
+
+    // access by id, for comparators
+    quint32 idAt(int index) const;
+    int indexOfId(quint32 id) const;
+    QString nameOf(quint32 id) const;
+    quint64 sizeOf(quint32 id) const;
+    qint64 modifyTimeOf(quint32 id) const;
+
+    // size and modifyTime can be filled in later
+    bool hasStat(int index) const;
+    bool hasStatOf(quint32 id) const;
+    void setStatOf(quint32 id, quint64 size, qint64 modifyTime);
+    // ids of entries without size / modifyTime
+    std::vector<quint32> missingStats() const;
+
+    // collation keys, computed once per entry
+    bool hasSortKey(quint32 id) const;
+    const QCollatorSortKey &sortKeyOf(quint32 id) const;
+    void setSortKey(quint32 id, const QCollatorSortKey &key);
+    // ids of entries without a key
+    std::vector<quint32> missingSortKeys() const;
+
+    // reorders entries; cmp takes two ids
+    template<typename Compare>
+    void sort(Compare cmp) {
+        parallelSort(order, cmp);
+        updatePositions(0);
+    }
+    // position in current order where an entry would be inserted
+    template<typename Compare>
+    int upperBound(quint32 id, Compare cmp) const {
+        return static_cast<int>(std::upper_bound(order.begin(), order.end(), id, cmp) - order.begin());
+    }
+    // moves an already stored entry to a new position
+    void move(int from, int to);
+    // takes the order of a sorted copy of this list, along with the keys and
+    // stats it computed; entries added since the copy go to the end
+    // returns the number of entries in sorted order
+    int adoptOrder(const EntryList &sorted);
+    // sorts the entries from index `from` to the end and merges them
+    // into the already sorted part before it
+    template<typename Compare>
+    void mergeTail(int from, Compare cmp) {
+        if(from < 0 || from >= count())
+            return;
+        std::sort(order.begin() + from, order.end(), cmp);
+        // nothing before this position moves
+        int first = static_cast<int>(std::upper_bound(order.begin(), order.begin() + from, order[from], cmp) - order.begin());
+        std::inplace_merge(order.begin(), order.begin() + from, order.end(), cmp);
+        updatePositions(first);
+    }
+
+private:
+    struct Record {
+        quint32 nameOffset;
+        quint32 hash;
+        quint16 nameLength;
+        bool isDirectory;
+        bool hasStat;
+        bool alive;
+    };
+    static constexpr quint32 EMPTY = 0;
+
+    std::vector<QChar> names;
+    std::vector<Record> records;
+    std::vector<quint64> sizes;
+    std::vector<qint64> modifyTimes;
+    std::vector<std::optional<QCollatorSortKey>> sortKeys;
+    std::vector<quint32> freeIds;
+    // index -> id, id -> index
+    std::vector<quint32> order, positions;
+    // id + 1, EMPTY for free slots
+    std::vector<quint32> buckets;
+    size_t garbage;
+
+    quint32 store(const QString &name, quint64 size, qint64 modifyTime, bool isDirectory, bool hasStat);
+    void release(quint32 id);
+    void updatePositions(int from);
+
+    static quint32 hashOf(const QChar *data, int length);
+    bool nameEquals(quint32 id, const QChar *data, int length) const;
+    size_t findBucket(const QChar *data, int length) const;
+    void hashInsert(quint32 id);
+    void hashRemove(quint32 id);
+    void rehash(size_t bucketCount);
+    void compactNames();
+};
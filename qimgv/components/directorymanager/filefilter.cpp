@@ -0,0 +1,47 @@
+#include "filefilter.h"
+
+FileFilter::FileFilter() : maxLength(0) {
+}
+
+bool FileFilter::setFormats(const QList<QByteArray> &formats) {
+    if(formats == formatList)
+        return false;
+    formatList = formats;
+    extensions.clear();
+    maxLength = 0;
+    for(auto &format : formats) {
+        extensions.insert(format.toLower());
+        maxLength = qMax(maxLength, format.length());
+    }
+    return true;
+}
+
+bool FileFilter::matches(const QString &fileName) const {
+    return matchSuffix(fileName.utf16(), fileName.length());
+}
+
+bool FileFilter::matches(const std::filesystem::path::string_type &fileName) const {
+    return matchSuffix(fileName.data(), static_cast<int>(fileName.length()));
+}
+
+template<typename CharT>
+bool FileFilter::matchSuffix(const CharT *data, int length) const {
+    char suffix[32];
+    if(maxLength > static_cast<int>(sizeof(suffix)))
+        return false;
+    int dot = length - 1;
+    while(dot >= 0 && data[dot] != '.' && length - dot <= maxLength)
+        dot--;
+    if(dot < 0 || data[dot] != '.')
+        return false;
+    int suffixLength = length - dot - 1;
+    if(suffixLength == 0)
+        return false;
+    for(int i = 0; i < suffixLength; i++) {
+        auto c = data[dot + 1 + i];
+        if(c <= 0 || c >= 128)
+            return false;
+        suffix[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : static_cast<char>(c);
+    }
+    return extensions.contains(QByteArray::fromRawData(suffix, suffixLength));
+}
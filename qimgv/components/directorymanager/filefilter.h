@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QSet>
+#include <QList>
+#include <QString>
+#include <QByteArray>
+#include <filesystem>
+
+/* Matches file names by extension.
+ *
+ * Extensions are stored lowercased in a hash set; a lookup folds the suffix
+ * of the name into a small stack buffer, so no allocations are made and
+ * names with long or non-ascii suffixes are rejected right away.
+ */
+
+class FileFilter {
+public:
+    FileFilter();
+    // returns false if the format list didn't change
+    bool setFormats(const QList<QByteArray> &formats);
+    bool matches(const QString &fileName) const;
+    // native file name as returned by std::filesystem
+    bool matches(const std::filesystem::path::string_type &fileName) const;
+
+private:
+    QList<QByteArray> formatList;
+    QSet<QByteArray> extensions;
+    int maxLength;
+
+    template<typename CharT>
+    bool matchSuffix(const CharT *data, int length) const;
+};
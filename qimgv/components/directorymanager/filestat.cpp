@@ -0,0 +1,40 @@
+#include "filestat.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <fcntl.h>
+#define USE_POSIX_STAT
+#endif
+
+bool readFileStat(const std::filesystem::path &path, FileStat &st) {
+#if defined(__linux__) && defined(STATX_SIZE)
+    // only ask for what we use; lets network filesystems skip the rest
+    struct statx sx;
+    if(statx(AT_FDCWD, path.c_str(), 0, STATX_SIZE | STATX_MTIME | STATX_INO, &sx) != 0)
+        return false;
+    st.size = sx.stx_size;
+    st.modifyTime = static_cast<qint64>(sx.stx_mtime.tv_sec) * 1000000000 + sx.stx_mtime.tv_nsec;
+    st.inode = sx.stx_ino;
+    return true;
+#elif defined(USE_POSIX_STAT)
+    struct stat sb;
+    if(stat(path.c_str(), &sb) != 0)
+        return false;
+    st.size = static_cast<quint64>(sb.st_size);
+    st.modifyTime = static_cast<qint64>(sb.st_mtime) * 1000000000;
+    st.inode = static_cast<quint64>(sb.st_ino);
+    return true;
+#else
+    std::error_code ec;
+    if(!std::filesystem::is_directory(path, ec)) {
+        st.size = std::filesystem::file_size(path, ec);
+        if(ec)
+            return false;
+    }
+    auto time = std::filesystem::last_write_time(path, ec);
+    if(ec)
+        return false;
+    st.modifyTime = static_cast<qint64>(time.time_since_epoch().count());
+    return true;
+#endif
+}
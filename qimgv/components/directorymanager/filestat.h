@@ -0,0 +1,17 @@
+#pragma once
+
+#include <QtGlobal>
+#include <filesystem>
+
+// Size and modify time of a single file or directory.
+// modifyTime is only meant to be compared with other values from here.
+// inode is 0 where not available.
+struct FileStat {
+    quint64 size = 0;
+    qint64 modifyTime = 0;
+    quint64 inode = 0;
+};
+
+// statx() on linux, stat() on other unix systems, std::filesystem elsewhere
+// returns false if the file can't be read
+bool readFileStat(const std::filesystem::path &path, FileStat &st);
@@ -1,9 +1,11 @@
 #include "directorywatcher_p.h"
 
 #include <QRegExp>
+#include "polling/pollingwatcher.h"
 
 #ifdef __linux__
 #include "linux/linuxwatcher.h"
+#include <sys/vfs.h>
 #elif _WIN32
 #include "windows/windowswatcher.h"
 #elif __unix__
@@ -51,11 +53,56 @@ DirectoryWatcher *DirectoryWatcher::newInstance()
     return watcher;
 }
 
+DirectoryWatcher *DirectoryWatcher::newInstance(const QString& path) {
+    if (isNetworkPath(path))
+        return new PollingWatcher();
+    return newInstance();
+}
+
+bool DirectoryWatcher::isNetworkPath(const QString& path) {
+#ifdef __linux__
+    struct statfs fs;
+    if (statfs(path.toStdString().c_str(), &fs) != 0)
+        return false;
+    switch (static_cast<unsigned long>(fs.f_type)) {
+    case 0x6969:     // nfs
+    case 0x517B:     // smb
+    case 0xFF534D42: // cifs
+    case 0xFE534D42: // smb2
+    case 0x65735546: // fuse (sshfs and friends)
+    case 0x01021997: // 9p
+    case 0x00C36400: // ceph
+    case 0x5346414F: // afs
+    case 0x73757245: // coda
+        return true;
+    default:
+        return false;
+    }
+#else
+    Q_UNUSED(path)
+    return false;
+#endif
+}
+
+void DirectoryWatcher::deleteWhenStopped() {
+    Q_D(DirectoryWatcher);
+    if (!d->workerThread->isRunning()) {
+        deleteLater();
+        return;
+    }
+    connect(d->workerThread.data(), &QThread::finished, this, &QObject::deleteLater);
+    stopObserving();
+}
+
 void DirectoryWatcher::setWatchPath(const QString& path) {
     Q_D(DirectoryWatcher);
     d->currentDirectory = path;
 }
 
+void DirectoryWatcher::setSubdirectories(const QStringList& dirs) {
+    Q_UNUSED(dirs);
+}
+
 QString DirectoryWatcher::watchPath() const {
     Q_D(const DirectoryWatcher);
     return d->currentDirectory;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include <QStringList>
 
 class DirectoryWatcherPrivate;
 
@@ -8,11 +9,20 @@ class DirectoryWatcher : public QObject {
     Q_OBJECT
 public:
     static DirectoryWatcher* newInstance();
+    // picks a polling watcher for network mounts
+    static DirectoryWatcher* newInstance(const QString& path);
+    // true if native change notifications can't be trusted for this path
+    static bool isNetworkPath(const QString& path);
 
     virtual ~DirectoryWatcher();
 
     virtual void setWatchPath(const QString& watchPath);
     virtual QString watchPath() const;
+    // Recursive listing: also watch these directories (relative to watchPath).
+    // Replaces the previous set. Backends that can't do it ignore the call.
+    virtual void setSubdirectories(const QStringList& dirs);
+    // stops observing and deletes the watcher after its thread exits
+    void deleteWhenStopped();
 
 public Q_SLOTS:
     void observe();
@@ -23,6 +33,9 @@ signals:
     void fileDeleted(const QString& filePath);
     void fileRenamed(const QString& old, const QString& now);
     void fileModified(const QString& filePath);
+    // the directory needs to be re-read; either some events were dropped,
+    // or the backend can only tell that something changed
+    void rescanNeeded();
 
     void observingStarted();
     void observingStopped();
@@ -1,21 +1,15 @@
 #pragma once
 
-#include <QObject>
-
-class LinuxFsEvent : public QObject
-{
-public:
-    LinuxFsEvent(char* data, uint dataSize);
-    ~LinuxFsEvent();
-
-    uint dataSize() const;
-    void setDataSize(uint dataSize);
-
-    char *data() const;
-    void setData(char *data);
-
-private:
-    char* mData;
-    uint mDataSize;
-
+#include <QString>
+#include <QVector>
+#include <QMetaType>
+
+// inotify event, parsed on the worker thread
+struct LinuxFsEvent {
+    int wd;
+    uint mask;
+    uint cookie;
+    QString name;
 };
+
+Q_DECLARE_METATYPE(QVector<LinuxFsEvent>)
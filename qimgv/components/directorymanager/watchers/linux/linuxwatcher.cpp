@@ -1,6 +1,7 @@
 #include <QTimer>
 
 #include <sys/inotify.h>
+#include <unistd.h>
 
 #include "linuxwatcher_p.h"
 #include "linuxworker.h"
@@ -12,60 +13,73 @@
   * Time to wait for rename event. If event take time longer
   * than specified then event will be considered as remove event
   */
-
-// TODO: this may break event order.
-// Implement a proper queue.
 #define EVENT_MOVE_TIMEOUT      150 // ms
 #define EVENT_MODIFY_TIMEOUT    150 // ms
 
 LinuxWatcherPrivate::LinuxWatcherPrivate(LinuxWatcher* qq) :
     DirectoryWatcherPrivate(qq, new LinuxWorker()),
     watcher(-1),
-    watchObject(-1)
+    watchObject(-1),
+    recursive(false),
+    queueHead(0)
 {
     watcher = inotify_init();
+    clock.start();
+    dispatchTimer.setSingleShot(true);
+    connect(&dispatchTimer, &QTimer::timeout, this, &LinuxWatcherPrivate::dispatchEvents);
 }
 
-int LinuxWatcherPrivate::indexOfWatcherEvent(uint cookie) const {
-    for (int i = 0; i < watcherEvents.size(); ++i) {
-        auto event = watcherEvents.at(i);
-        if (event->cookie() == cookie) {
-            return i;
-        }
-    }
-    return -1;
+void LinuxWatcherPrivate::enqueue(const WatcherEvent &event) {
+    eventQueue.push_back(event);
 }
 
-int LinuxWatcherPrivate::indexOfWatcherEvent(const QString& name) const {
-    for (int i = 0; i < watcherEvents.size(); ++i) {
-        auto event = watcherEvents.at(i);
-        if (event->name() == name) {
-            return i;
-        }
+// nullptr if already dispatched
+WatcherEvent *LinuxWatcherPrivate::eventAt(quint64 seq) {
+    if (seq < queueHead || seq - queueHead >= eventQueue.size()) {
+        return nullptr;
     }
-    return -1;
+    return &eventQueue[seq - queueHead];
 }
 
-void LinuxWatcherPrivate::dispatchFilesystemEvent(LinuxFsEvent* e) {
-    Q_Q(LinuxWatcher);
-
-    uint dataOffset = 0;
-    QScopedPointer<LinuxFsEvent> event(e);
-
-    while (dataOffset < event->dataSize()) {
-        inotify_event* notify_event = (inotify_event*) (event->data() + dataOffset);
-        dataOffset += sizeof(inotify_event) + notify_event->len;
+void LinuxWatcherPrivate::clearQueue() {
+    dispatchTimer.stop();
+    queueHead += eventQueue.size();
+    eventQueue.clear();
+    movesByCookie.clear();
+    modifiesByName.clear();
+}
 
-        int mask        = notify_event->mask;
-        QString name    = notify_event->name;
-        uint cookie     = notify_event->cookie;
-        bool isDirEvent = mask & IN_ISDIR;
-        
-        // Skip events for directories and files that isn't in filter range
-        if ( (isDirEvent) && !(mask & IN_MOVED_TO) ) {
+void LinuxWatcherPrivate::onFileEvents(QVector<LinuxFsEvent> events) {
+    for (auto &event : events) {
+        uint mask = event.mask;
+        if (mask & IN_Q_OVERFLOW) {
+            qDebug() << TAG << "Event queue overflow";
+            handleRescanEvent();
             continue;
         }
-
+        auto prefix = watchPrefixes.find(event.wd);
+        // Stale event of a removed watch
+        if (prefix == watchPrefixes.end()) {
+            continue;
+        }
+        if (mask & IN_IGNORED) {
+            // Watched directory is gone
+            watchPrefixes.erase(prefix);
+            continue;
+        }
+        if (mask & IN_ISDIR) {
+            // A directory coming or going changes a recursive listing in
+            // ways single file events can't describe. In a flat listing
+            // only the ones moved in are passed on, as before.
+            if (recursive) {
+                handleRescanEvent();
+                continue;
+            }
+            if (!(mask & IN_MOVED_TO)) {
+                continue;
+            }
+        }
+        QString name = prefix.value() + event.name;
         if (mask & IN_MODIFY) {
             handleModifyEvent(name);
         } else if (mask & IN_CREATE) {
@@ -73,88 +87,122 @@ void LinuxWatcherPrivate::dispatchFilesystemEvent(LinuxFsEvent* e) {
         } else if (mask & IN_DELETE) {
             handleDeleteEvent(name);
         } else if (mask & IN_MOVED_FROM) {
-            handleMovedFromEvent(name, cookie);
+            handleMovedFromEvent(name, event.cookie);
         } else if (mask & IN_MOVED_TO) {
-            handleMovedToEvent(name, cookie);
+            handleMovedToEvent(name, event.cookie);
         }
     }
+    dispatchEvents();
 }
 
 void LinuxWatcherPrivate::handleModifyEvent(const QString &name) {
-    // Find the same event in the list by file name
-    int eventIndex = indexOfWatcherEvent(name);
-    if (eventIndex == -1) {
-        // This is this first modify event for the current file
-        int timerId = startTimer(EVENT_MODIFY_TIMEOUT);
-        auto event = new WatcherEvent(name, timerId, WatcherEvent::Modify);
-        watcherEvents.append(QSharedPointer<WatcherEvent>(event));
-    } else {
-        auto event = watcherEvents.at(eventIndex);
-        // Restart timer again
-        killTimer(event->timerId());
-        int timerId = startTimer(EVENT_MODIFY_TIMEOUT);
-        event->setTimerId(timerId);
+    qint64 deadline = clock.elapsed() + EVENT_MODIFY_TIMEOUT;
+    // Same file modified again: drop the waiting event and wait from now
+    auto it = modifiesByName.find(name);
+    if (it != modifiesByName.end()) {
+        if (auto event = eventAt(it.value())) {
+            event->setType(WatcherEvent::None);
+        }
     }
+    modifiesByName.insert(name, queueHead + eventQueue.size());
+    enqueue(WatcherEvent(name, deadline, WatcherEvent::Modify));
 }
 
 void LinuxWatcherPrivate::handleDeleteEvent(const QString &name) {
-    Q_Q(LinuxWatcher);
-    emit q->fileDeleted(name);
+    enqueue(WatcherEvent(name, clock.elapsed(), WatcherEvent::Delete));
 }
 
 void LinuxWatcherPrivate::handleCreateEvent(const QString &name) {
-    Q_Q(LinuxWatcher);
-    emit q->fileCreated(name);
+    enqueue(WatcherEvent(name, clock.elapsed(), WatcherEvent::Create));
 }
 
 void LinuxWatcherPrivate::handleMovedFromEvent(const QString &name, uint cookie) {
-    int timerId = startTimer(EVENT_MOVE_TIMEOUT);
-    // Save timer id to find out later which event timer is running
-    auto event = new WatcherEvent(name, cookie, timerId, WatcherEvent::MovedFrom);
-    watcherEvents.append(QSharedPointer<WatcherEvent>(event));
+    movesByCookie.insert(cookie, queueHead + eventQueue.size());
+    enqueue(WatcherEvent(name, cookie, clock.elapsed() + EVENT_MOVE_TIMEOUT, WatcherEvent::MovedFrom));
 }
 
 void LinuxWatcherPrivate::handleMovedToEvent(const QString &name, uint cookie) {
-    Q_Q(LinuxWatcher);
-
     // Check if file waiting to be renamed
-    int eventIndex = indexOfWatcherEvent(cookie);
-    if (eventIndex == -1) {
+    WatcherEvent *movedFrom = nullptr;
+    auto it = movesByCookie.find(cookie);
+    if (it != movesByCookie.end()) {
+        movedFrom = eventAt(it.value());
+        movesByCookie.erase(it);
+    }
+    if (!movedFrom) {
         // No one event waiting for rename so this is a new file
-        emit q->fileCreated(name);
+        enqueue(WatcherEvent(name, clock.elapsed(), WatcherEvent::Create));
     } else {
-        // Waiting for rename event is found
-        auto watcherEvent = watcherEvents.takeAt(eventIndex);
-        // Kill associated timer
-        killTimer(watcherEvent->timerId());
-        emit q->fileRenamed(watcherEvent->name(), name);
+        // Becomes a rename in place, keeping its position in the queue
+        movedFrom->setType(WatcherEvent::Rename);
+        movedFrom->setNewName(name);
+        movedFrom->setDeadline(clock.elapsed());
+    }
+}
+
+// Events were lost or can't be mapped to files.
+// Whatever is already queued is still valid and goes out first.
+void LinuxWatcherPrivate::handleRescanEvent() {
+    // One rescan covers everything up to it
+    if (!eventQueue.empty() && eventQueue.back().type() == WatcherEvent::Rescan) {
+        return;
+    }
+    enqueue(WatcherEvent(QString(), clock.elapsed(), WatcherEvent::Rescan));
+}
+
+void LinuxWatcherPrivate::removeWatches() {
+    for (auto it = watchPrefixes.begin(); it != watchPrefixes.end(); ++it) {
+        inotify_rm_watch(watcher, it.key());
     }
+    watchPrefixes.clear();
+    watchObject = -1;
 }
 
-void LinuxWatcherPrivate::timerEvent(QTimerEvent *timerEvent) {
+void LinuxWatcherPrivate::dispatchEvents() {
     Q_Q(LinuxWatcher);
 
-    // Loop through waiting move events
-    int lastIndex = watcherEvents.size() - 1;
-    for (int i = lastIndex; i >= 0; --i) {
-        auto watcherEvent = watcherEvents.at(i);
-
-        if (watcherEvent->timerId() == timerEvent->timerId()) {
-            int type = watcherEvent->type();
-            if (type == WatcherEvent::MovedFrom) {
-                // Rename event didn't happen so treat this event as remove event
-                emit q->fileDeleted(watcherEvent->name());
-            } else if (type == WatcherEvent::Modify) {
-                emit q->fileModified(watcherEvent->name());
+    qint64 now = clock.elapsed();
+    while (!eventQueue.empty()) {
+        WatcherEvent &front = eventQueue.front();
+        if (front.type() != WatcherEvent::None && front.deadline() > now) {
+            break;
+        }
+        WatcherEvent event = front;
+        quint64 seq = queueHead;
+        eventQueue.pop_front();
+        queueHead++;
+
+        switch (event.type()) {
+        case WatcherEvent::MovedFrom:
+            movesByCookie.remove(event.cookie());
+            // Rename event didn't happen so treat this event as remove event
+            emit q->fileDeleted(event.name());
+            break;
+        case WatcherEvent::Modify:
+            if (modifiesByName.value(event.name()) == seq) {
+                modifiesByName.remove(event.name());
             }
-
-            watcherEvents.removeAt(i);
+            emit q->fileModified(event.name());
+            break;
+        case WatcherEvent::Rename:
+            emit q->fileRenamed(event.name(), event.newName());
+            break;
+        case WatcherEvent::Create:
+            emit q->fileCreated(event.name());
+            break;
+        case WatcherEvent::Delete:
+            emit q->fileDeleted(event.name());
+            break;
+        case WatcherEvent::Rescan:
+            emit q->rescanNeeded();
+            break;
+        default:
             break;
         }
     }
-
-    // Stop timer anyway
-    killTimer(timerEvent->timerId());
+    if (!eventQueue.empty()) {
+        dispatchTimer.start(static_cast<int>(qMax<qint64>(0, eventQueue.front().deadline() - now)));
+    }
 }
 
 LinuxWatcher::LinuxWatcher() : DirectoryWatcher(new LinuxWatcherPrivate(this)) {
@@ -166,8 +214,9 @@ LinuxWatcher::LinuxWatcher() : DirectoryWatcher(new LinuxWatcherPrivate(this)) {
     auto linuxWorker = static_cast<LinuxWorker*>(d->worker.data());
     linuxWorker->setDescriptor(d->watcher);
 
-    connect(linuxWorker, &LinuxWorker::fileEvent,
-            d, &LinuxWatcherPrivate::dispatchFilesystemEvent);
+    qRegisterMetaType<QVector<LinuxFsEvent>>("QVector<LinuxFsEvent>");
+    connect(linuxWorker, &LinuxWorker::fileEvents,
+            d, &LinuxWatcherPrivate::onFileEvents);
 
     // Here's no need to destroy thread and worker. They're will be removed automatically
     connect(linuxWorker, &LinuxWorker::finished, d->workerThread.data(), &QThread::quit);
@@ -178,27 +227,58 @@ LinuxWatcher::LinuxWatcher() : DirectoryWatcher(new LinuxWatcherPrivate(this)) {
 
 LinuxWatcher::~LinuxWatcher() {
     Q_D(LinuxWatcher);
-    int removeStatusCode = inotify_rm_watch(d->watcher, d->watchObject);
-    if (removeStatusCode != 0) {
-        qDebug() << TAG << "Cannot remove inotify watcher instance:" << strerror(errno);
-    }
+    // Closing the instance drops all of its watches
+    close(d->watcher);
 }
 
 void LinuxWatcher::setWatchPath(const QString& path) {
     Q_D(LinuxWatcher);
     DirectoryWatcher::setWatchPath(path);
+    // Pending events belong to the old directory
+    d->clearQueue();
 
-    // Subscribe for specified filesystem events
-    if (d->watchObject != -1) {
-        int status = inotify_rm_watch(d->watcher, d->watchObject);
-        if (status == -1) {
-            qDebug() << TAG << "Error:" << strerror(errno);
-        }
-    }
+    // Subdirectories are set again after the new path is listed
+    d->removeWatches();
+    d->recursive = false;
 
     // Add new path to be watched by inotify
     d->watchObject = inotify_add_watch(d->watcher, path.toStdString().data(), INOTIFY_EVENT_MASK);
     if (d->watchObject == -1) {
         qDebug() << TAG << "Error:" << strerror(errno);
+    } else {
+        d->watchPrefixes.insert(d->watchObject, QString());
+    }
+}
+
+// Only the difference to the current set is applied, so a relisting
+// doesn't drop and re-add thousands of watches.
+void LinuxWatcher::setSubdirectories(const QStringList& dirs) {
+    Q_D(LinuxWatcher);
+    d->recursive = true;
+    QSet<QString> added;
+    for (auto &dir : dirs) {
+        added.insert(dir + "/");
+    }
+    for (auto it = d->watchPrefixes.begin(); it != d->watchPrefixes.end();) {
+        if (it.key() != d->watchObject && !added.contains(it.value())) {
+            inotify_rm_watch(d->watcher, it.key());
+            it = d->watchPrefixes.erase(it);
+        } else {
+            added.remove(it.value());
+            ++it;
+        }
+    }
+    for (auto &prefix : added) {
+        QString path = watchPath() + "/" + prefix;
+        int wd = inotify_add_watch(d->watcher, path.toStdString().data(), INOTIFY_EVENT_MASK);
+        if (wd == -1) {
+            qDebug() << TAG << "Cannot watch" << path << strerror(errno);
+            // Out of watches (fs.inotify.max_user_watches), the rest will fail too
+            if (errno == ENOSPC) {
+                break;
+            }
+            continue;
+        }
+        d->watchPrefixes.insert(wd, prefix);
     }
 }
@@ -10,6 +10,7 @@ public:
     explicit LinuxWatcher();
     virtual ~LinuxWatcher();
     virtual void setWatchPath(const QString& p);
+    virtual void setSubdirectories(const QStringList& dirs);
 
 private:
     Q_DECLARE_PRIVATE(LinuxWatcher)
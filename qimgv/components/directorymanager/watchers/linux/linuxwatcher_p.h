@@ -3,37 +3,55 @@
 
 #include "../linux/linuxwatcher.h"
 #include "../directorywatcher_p.h"
+#include "linuxfsevent.h"
 
 #include <errno.h>
+#include <deque>
 #include <QDebug>
 #include <QTimer>
-
-class LinuxFsEvent;
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
 
 class LinuxWatcherPrivate : public DirectoryWatcherPrivate {
     Q_OBJECT
 public:
     explicit LinuxWatcherPrivate(LinuxWatcher* qq = 0);
 
-    int indexOfWatcherEvent(uint cookie) const;
-    int indexOfWatcherEvent(const QString& name) const;
-
     void handleModifyEvent(const QString& name);
     void handleDeleteEvent(const QString& name);
     void handleCreateEvent(const QString& name);
     void handleMovedFromEvent(const QString& name, uint cookie);
     void handleMovedToEvent(const QString& name, uint cookie);
+    void handleRescanEvent();
 
     int watcher;
     int watchObject;
-
-    QVector<QSharedPointer<WatcherEvent>> watcherEvents;
-
-protected:
-    virtual void timerEvent(QTimerEvent* timerEvent) override;
+    // watch descriptor -> directory relative to the watch path, with a
+    // trailing slash; empty for the watch path itself
+    QHash<int, QString> watchPrefixes;
+    // subdirectories are watched too
+    bool recursive;
+    void removeWatches();
+
+    // Pending events in arrival order. Events are dispatched from the front
+    // once their deadline passes, so a waiting move or modify holds back
+    // everything that came after it.
+    std::deque<WatcherEvent> eventQueue;
+    // sequence number of eventQueue.front()
+    quint64 queueHead;
+    QHash<uint, quint64> movesByCookie;
+    QHash<QString, quint64> modifiesByName;
+    QTimer dispatchTimer;
+    QElapsedTimer clock;
+
+    void enqueue(const WatcherEvent &event);
+    WatcherEvent *eventAt(quint64 seq);
+    void clearQueue();
 
 private slots:
-    void dispatchFilesystemEvent(LinuxFsEvent *e);
+    void onFileEvents(QVector<LinuxFsEvent> events);
+    void dispatchEvents();
 
 private:
     Q_DECLARE_PUBLIC(LinuxWatcher)
@@ -1,5 +1,6 @@
 #include <sys/poll.h>
 #include <sys/ioctl.h>
+#include <sys/inotify.h>
 #include <unistd.h>
 
 #include <QThread>
@@ -52,16 +53,44 @@ void LinuxWorker::run() {
             continue;
         }
 
-        char* eventData = new char[bytesAvailable];
-        errorCode = read(fd, eventData, bytesAvailable);
-        handleErrorCode(errorCode);
+        if (bytesAvailable > buffer.size()) {
+            buffer.resize(bytesAvailable);
+        }
+        ssize_t bytesRead = read(fd, buffer.data(), buffer.size());
+        if (bytesRead <= 0) {
+            handleErrorCode(-1);
+            continue;
+        }
 
-        emit fileEvent(new LinuxFsEvent(eventData, bytesAvailable));
+        QVector<LinuxFsEvent> events = parseEvents(static_cast<size_t>(bytesRead));
+        if (!events.isEmpty()) {
+            emit fileEvents(events);
+        }
     }
 
     emit finished();
 }
 
+// Parsing happens here so the gui thread only gets the events it cares about
+QVector<LinuxFsEvent> LinuxWorker::parseEvents(size_t size) const {
+    QVector<LinuxFsEvent> events;
+    size_t dataOffset = 0;
+    while (dataOffset + sizeof(inotify_event) <= size) {
+        const inotify_event* notifyEvent = reinterpret_cast<const inotify_event*>(buffer.data() + dataOffset);
+        dataOffset += sizeof(inotify_event) + notifyEvent->len;
+
+        LinuxFsEvent event;
+        event.wd = notifyEvent->wd;
+        event.mask = notifyEvent->mask;
+        event.cookie = notifyEvent->cookie;
+        if (notifyEvent->len) {
+            event.name = QString::fromUtf8(notifyEvent->name);
+        }
+        events.append(event);
+    }
+    return events;
+}
+
 void LinuxWorker::handleErrorCode(int code) {
     if (code == -1) {
         qDebug() << TAG << strerror(errno);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include "linuxfsevent.h"
 #include "../watcherworker.h"
 
@@ -15,8 +16,12 @@ public:
     virtual void run() override;
 
 signals:
-    void fileEvent(LinuxFsEvent* event);
+    void fileEvents(QVector<LinuxFsEvent> events);
 
 private:
     int fd;
+    // reused between reads, only grows
+    std::vector<char> buffer;
+
+    QVector<LinuxFsEvent> parseEvents(size_t size) const;
 };
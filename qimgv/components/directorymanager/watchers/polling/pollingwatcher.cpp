@@ -0,0 +1,29 @@
+#include "pollingwatcher.h"
+#include "pollingworker.h"
+#include "../directorywatcher_p.h"
+
+class PollingWatcherPrivate : public DirectoryWatcherPrivate {
+public:
+    PollingWatcherPrivate(PollingWatcher* qq) : DirectoryWatcherPrivate(qq, new PollingWorker()) {}
+};
+
+PollingWatcher::PollingWatcher() : DirectoryWatcher(new PollingWatcherPrivate(this)) {
+    Q_D(PollingWatcher);
+
+    connect(d->workerThread.data(), &QThread::started, d->worker.data(), &WatcherWorker::run);
+    d->worker.data()->moveToThread(d->workerThread.data());
+
+    auto pollingWorker = static_cast<PollingWorker*>(d->worker.data());
+    connect(pollingWorker, &PollingWorker::directoryChanged, this, &PollingWatcher::rescanNeeded);
+
+    connect(pollingWorker, &PollingWorker::finished, d->workerThread.data(), &QThread::quit);
+
+    connect(pollingWorker, &PollingWorker::started, this, &PollingWatcher::observingStarted);
+    connect(pollingWorker, &PollingWorker::finished, this, &PollingWatcher::observingStopped);
+}
+
+void PollingWatcher::setWatchPath(const QString& path) {
+    Q_D(PollingWatcher);
+    DirectoryWatcher::setWatchPath(path);
+    static_cast<PollingWorker*>(d->worker.data())->setPath(path);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../directorywatcher.h"
+
+class PollingWatcherPrivate;
+
+/* Watcher for network filesystems, where inotify sees no remote changes.
+ * Only the directory's mtime is polled; when it changes, rescanNeeded()
+ * is emitted and the listing is diffed by the directory manager.
+ */
+
+class PollingWatcher : public DirectoryWatcher {
+    Q_OBJECT
+public:
+    explicit PollingWatcher();
+    virtual void setWatchPath(const QString& path);
+
+private:
+    Q_DECLARE_PRIVATE(PollingWatcher)
+};
@@ -0,0 +1,67 @@
+#include <QDebug>
+
+#include "pollingworker.h"
+#include "utils/stuff.h"
+
+#define TAG         "[PollingWorker]"
+
+PollingWorker::PollingWorker() :
+    pathChanged(false)
+{
+}
+
+void PollingWorker::setPath(const QString &newPath) {
+    QMutexLocker locker(&mutex);
+    path = newPath;
+    pathChanged = true;
+    wakeUp.wakeAll();
+}
+
+void PollingWorker::setRunning(bool running) {
+    QMutexLocker locker(&mutex);
+    WatcherWorker::setRunning(running);
+    wakeUp.wakeAll();
+}
+
+void PollingWorker::run() {
+    emit started();
+
+    FileStat last;
+    bool hasLast = false;
+    int interval = MIN_INTERVAL;
+
+    QMutexLocker locker(&mutex);
+    while (isRunning) {
+        if (pathChanged) {
+            // new baseline, no event for the initial state
+            pathChanged = false;
+            hasLast = false;
+            interval = MIN_INTERVAL;
+        }
+        QString currentPath = path;
+        locker.unlock();
+
+        // a stat on a stalled mount can block, keep it off the lock
+        FileStat current;
+        bool ok = !currentPath.isEmpty() && readFileStat(toStdString(currentPath), current);
+
+        locker.relock();
+        if (pathChanged || !isRunning) {
+            continue;
+        }
+        if (ok && hasLast && (current.modifyTime != last.modifyTime || current.inode != last.inode)) {
+            emit directoryChanged();
+            interval = MIN_INTERVAL;
+        } else {
+            interval = qMin(interval * 2, MAX_INTERVAL);
+        }
+        if (ok) {
+            last = current;
+            hasLast = true;
+        }
+        wakeUp.wait(&mutex, static_cast<unsigned long>(interval));
+    }
+    locker.unlock();
+
+    emit finished();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+#include "../watcherworker.h"
+#include "../../filestat.h"
+
+class PollingWorker : public WatcherWorker
+{
+    Q_OBJECT
+public:
+    PollingWorker();
+
+    void setPath(const QString &path);
+    virtual void setRunning(bool running) override;
+
+    virtual void run() override;
+
+signals:
+    void directoryChanged();
+
+private:
+    QMutex mutex;
+    QWaitCondition wakeUp;
+    QString path;
+    bool pathChanged;
+
+    // interval doubles while nothing changes
+    const int MIN_INTERVAL = 1000;  // ms
+    const int MAX_INTERVAL = 30000; // ms
+};
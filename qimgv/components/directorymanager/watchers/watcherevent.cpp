@@ -1,17 +1,18 @@
 #include <QDebug>
 #include "watcherevent.h"
 
-WatcherEvent::WatcherEvent(const QString &name, int timerId, WatcherEvent::Type type) :
+WatcherEvent::WatcherEvent(const QString &name, qint64 deadline, WatcherEvent::Type type) :
     mName(name),
-    mTimerId(timerId),
+    mCookie(0),
+    mDeadline(deadline),
     mType(type)
 {
 }
 
-WatcherEvent::WatcherEvent(const QString& name, uint cookie, int timerId, Type type) :
+WatcherEvent::WatcherEvent(const QString& name, uint cookie, qint64 deadline, Type type) :
     mName(name),
     mCookie(cookie),
-    mTimerId(timerId),
+    mDeadline(deadline),
     mType(type)
 {
 }
@@ -27,6 +28,14 @@ void WatcherEvent::setName(const QString &name) {
     mName = name;
 }
 
+QString WatcherEvent::newName() const {
+    return mNewName;
+}
+
+void WatcherEvent::setNewName(const QString &newName) {
+    mNewName = newName;
+}
+
 WatcherEvent::Type WatcherEvent::type() const {
     return mType;
 }
@@ -35,12 +44,12 @@ void WatcherEvent::setType(WatcherEvent::Type type) {
     mType = type;
 }
 
-int WatcherEvent::timerId() const {
-    return mTimerId;
+qint64 WatcherEvent::deadline() const {
+    return mDeadline;
 }
 
-void WatcherEvent::setTimerId(int timerId) {
-    mTimerId = timerId;
+void WatcherEvent::setDeadline(qint64 deadline) {
+    mDeadline = deadline;
 }
 
 uint WatcherEvent::cookie() const {
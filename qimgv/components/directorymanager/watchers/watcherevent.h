@@ -8,29 +8,38 @@ public:
         None,
         MovedFrom,
         MovedTo,
-        Modify
+        Modify,
+        Create,
+        Delete,
+        Rename,
+        Rescan
     };
 
-    WatcherEvent(const QString &name,int timerId, Type type = None);
-    WatcherEvent(const QString& name, uint cookie, int timerId, Type type = None);
+    WatcherEvent(const QString &name, qint64 deadline, Type type = None);
+    WatcherEvent(const QString& name, uint cookie, qint64 deadline, Type type = None);
     ~WatcherEvent();
 
     QString name() const;
     void setName(const QString& name);
 
+    // rename target
+    QString newName() const;
+    void setNewName(const QString& newName);
+
     uint cookie() const;
     void setCookie(uint cookie);
 
-    int timerId() const;
-    void setTimerId(int timerId);
+    // the event is not dispatched before this time (ms)
+    qint64 deadline() const;
+    void setDeadline(qint64 deadline);
 
     Type type() const;
     void setType(Type type);
 
 private:
-    QString mName;
+    QString mName, mNewName;
     uint mCookie;
-    int mTimerId;
+    qint64 mDeadline;
     Type mType;
 
 };
@@ -10,7 +10,7 @@ public:
     virtual void run() = 0;
 
 public Q_SLOTS:
-    void setRunning(bool running);
+    virtual void setRunning(bool running);
 
 Q_SIGNALS:
     void error(const QString& errorMessage);
@@ -3,21 +3,32 @@
 DirectoryModel::DirectoryModel(QObject *parent) : QObject(parent) {
     thumbnailer = new Thumbnailer(&dirManager);
     scaler = new Scaler(&cache);
+    loader.setCompressedCache(&compressedCache);
 
     connect(&dirManager, &DirectoryManager::fileRemoved, this, &DirectoryModel::onFileRemoved);
     connect(&dirManager, &DirectoryManager::fileAdded, this, &DirectoryModel::onFileAdded);
     connect(&dirManager, &DirectoryManager::fileModified,this, &DirectoryModel::onFileModified);
     connect(&dirManager, &DirectoryManager::fileRenamed, this, &DirectoryModel::onFileRenamed);
+    connect(&dirManager, &DirectoryManager::filesAdded, this, &DirectoryModel::filesAdded);
+    connect(&dirManager, &DirectoryManager::filesRemoved, this, &DirectoryModel::onFilesRemoved);
+    connect(&dirManager, &DirectoryManager::filesModified, this, &DirectoryModel::onFilesModified);
     connect(&dirManager, &DirectoryManager::loaded, this, &DirectoryModel::loaded);
+    connect(&dirManager, &DirectoryManager::filesAppended, this, &DirectoryModel::filesAppended);
+    connect(&dirManager, &DirectoryManager::listingFinished, this, &DirectoryModel::listingFinished);
     connect(&dirManager, &DirectoryManager::sortingChanged, this, &DirectoryModel::onSortingChanged);
     connect(&loader, &Loader::loadFinished, this, &DirectoryModel::onItemReady);
     connect(thumbnailer, &Thumbnailer::thumbnailReady, this, &DirectoryModel::thumbnailReady);
     connect(this, &DirectoryModel::generateThumbnails, thumbnailer, &Thumbnailer::generateThumbnails);
+    connect(&fileOps, &FileOpQueue::itemFinished, this, &DirectoryModel::onFileOpItemFinished);
+    connect(&fileOps, &FileOpQueue::progress, this, &DirectoryModel::fileOpProgress);
+    connect(&fileOps, &FileOpQueue::finished, this, &DirectoryModel::fileOpFinished);
 }
 
 DirectoryModel::~DirectoryModel() {
     thumbnailer->clearTasks();
     loader.clearTasks();
+    // scaler callbacks run on the worker and touch the scaler and cache
+    taskScheduler->waitForDone(TASK_SCALE);
     delete scaler;
     delete thumbnailer;
 }
@@ -101,96 +112,38 @@ QDateTime DirectoryModel::lastModified(QString fileName) {
     return dirManager.lastModified(fileName);
 }
 
-void DirectoryModel::copyTo(QString destDir, QFileInfo srcFile, FileOpResult &result) {
-    QString srcName = srcFile.fileName();
-    // error checks
-    if(destDir == dirManager.directoryPath()) {
-        result = FileOpResult::COPY_TO_SAME_DIR;
-        return;
-    }
-    if(!dirManager.contains(srcName)) { // if this happens we have a bug
-        result = FileOpResult::SOURCE_DOES_NOT_EXIST;
-        return;
-    }
-    QFileInfo location(destDir);
-    if(!location.exists()) {
-        result = FileOpResult::DESTINATION_DOES_NOT_EXIST;
-        return;
-    }
-    if(!location.isWritable()) {
-        result = FileOpResult::DESTINATION_NOT_WRITABLE;
-        return;
-    }
-    location.setFile(destDir + "/" + srcName);
-    if(location.exists()) {
-        if(!location.isWritable())
-            result = FileOpResult::DESTINATION_NOT_WRITABLE;
-        result = FileOpResult::DESTINATION_FILE_EXISTS;
-        return;
-    }
-    // copy
-    if(dirManager.copyTo(destDir, srcName))
-        result = FileOpResult::SUCCESS;
-    else
-        result = FileOpResult::OTHER_ERROR;
-    return;
+void DirectoryModel::copyFiles(QStringList srcPaths, QString destDir) {
+    fileOps.copy(srcPaths, destDir);
 }
 
-void DirectoryModel::moveTo(QString destDir, QFileInfo srcFile, FileOpResult &result) {
-    QString srcName = srcFile.fileName();
-    // error checks
-    if(destDir == dirManager.directoryPath()) {
-        result = FileOpResult::COPY_TO_SAME_DIR;
-        return;
-    }
-    if(!dirManager.contains(srcName)) { // if this happens we have a bug
-        result = FileOpResult::SOURCE_DOES_NOT_EXIST;
-        return;
-    }
-    QFileInfo destLocation(destDir);
-    if(!destLocation.exists()) {
-        result = FileOpResult::DESTINATION_DOES_NOT_EXIST;
-        return;
-    }
-    if(!destLocation.isWritable()) {
-        result = FileOpResult::DESTINATION_NOT_WRITABLE;
-        return;
-    }
-    destLocation.setFile(destDir + "/" + srcName);
-    if(destLocation.exists()) {
-        if(!destLocation.isWritable())
-            result = FileOpResult::DESTINATION_NOT_WRITABLE;
-        result = FileOpResult::DESTINATION_FILE_EXISTS;
-        return;
-    }
-    if(!srcFile.isWritable()) {
-        result = FileOpResult::SOURCE_NOT_WRITABLE;
-        return;
-    }
-    // move
-    if(dirManager.copyTo(destDir, srcName)) {
-        // remove original file
-        if(dirManager.removeFile(srcName, false)) {
-            // OK
-            result = FileOpResult::SUCCESS;
-            return;
-        }
-        // revert on failure
-        result = FileOpResult::SOURCE_NOT_WRITABLE;
-        if(QFile::remove(destDir + "/" + srcName))
-            result = FileOpResult::OTHER_ERROR;
-    } else {
-        // could not COPY
-        result = FileOpResult::OTHER_ERROR;
+void DirectoryModel::moveFiles(QStringList srcPaths, QString destDir) {
+    fileOps.move(srcPaths, destDir);
+}
+
+void DirectoryModel::trashFiles(QStringList srcPaths) {
+    fileOps.trash(srcPaths);
+}
+
+// Drops moved files from the list right away instead of waiting for the watcher.
+void DirectoryModel::onFileOpItemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result) {
+    if(result == FileOpResult::SUCCESS && type != FILEOP_COPY) {
+        // relative to the model directory, in recursive mode it can include subdirectories
+        QString fileName = QDir(directoryPath()).relativeFilePath(srcPath);
+        dirManager.forgetFile(fileName);
     }
-    return;
+    emit fileOpItemFinished(type, srcPath, destPath, result);
 }
 // -----------------------------------------------------------------------------
 void DirectoryModel::setDirectory(QString path) {
     cache.clear();
+    BufferPool::trim();
     dirManager.setDirectory(path);
 }
 
+bool DirectoryModel::isLoading() const {
+    return dirManager.isLoading();
+}
+
 QString DirectoryModel::directoryPath() {
     return dirManager.directoryPath();
 }
@@ -202,6 +155,7 @@ void DirectoryModel::unload(int index) {
 
 void DirectoryModel::unload(QString fileName) {
     cache.remove(fileName);
+    compressedCache.remove(fullPath(fileName));
 }
 
 void DirectoryModel::unloadExcept(QString fileName, bool keepNearby) {
@@ -211,6 +165,9 @@ void DirectoryModel::unloadExcept(QString fileName, bool keepNearby) {
         list << prevOf(fileName);
         list << nextOf(fileName);
     }
+    for(auto &name : cache.keys())
+        if(!list.contains(name))
+            compressedCache.insert(cache.get(name));
     cache.trimTo(list);
 }
 
@@ -259,6 +216,28 @@ void DirectoryModel::onFileRemoved(QString fileName, int index) {
     emit fileRemoved(fileName, index);
 }
 
+void DirectoryModel::onFilesRemoved(QStringList fileNames, QList<int> indexes) {
+    for(auto &fileName : fileNames)
+        unload(fileName);
+    emit filesRemoved(fileNames, indexes);
+}
+
+// same as onFileModified(), with one signal for the whole batch
+void DirectoryModel::onFilesModified(QStringList fileNames) {
+    QStringList modified;
+    for(auto &fileName : fileNames) {
+        QDateTime modTime = lastModified(fileName);
+        if(!modTime.isValid())
+            continue;
+        auto img = cache.get(fileName);
+        if(img && modTime > img->lastModified())
+            reload(fileName);
+        modified.append(fileName);
+    }
+    if(!modified.isEmpty())
+        emit filesModified(modified);
+}
+
 void DirectoryModel::onFileRenamed(QString from, int indexFrom, QString to, int indexTo) {
     unload(from);
     emit fileRenamed(from, indexFrom, to, indexTo);
@@ -310,6 +289,7 @@ void DirectoryModel::load(QString fileName, bool asyncHint) {
 }
 
 void DirectoryModel::reload(QString fileName) {
+    compressedCache.remove(fullPath(fileName));
     if(cache.contains(fileName)) {
         cache.remove(fileName);
         load(fileName, false);
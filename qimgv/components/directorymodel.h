@@ -2,21 +2,12 @@
 
 #include <QObject>
 #include "cache/cache.h"
+#include "cache/compressedcache.h"
 #include "directorymanager/directorymanager.h"
 #include "scaler/scaler.h"
 #include "thumbnailer/thumbnailer.h"
 #include "loader/loader.h"
-
-enum FileOpResult {
-    SUCCESS,
-    DESTINATION_FILE_EXISTS,
-    SOURCE_NOT_WRITABLE,
-    DESTINATION_NOT_WRITABLE,
-    SOURCE_DOES_NOT_EXIST,
-    DESTINATION_DOES_NOT_EXIST,
-    COPY_TO_SAME_DIR,
-    OTHER_ERROR
-};
+#include "fileopqueue/fileopqueue.h"
 
 class DirectoryModel : public QObject {
     Q_OBJECT
@@ -43,9 +34,12 @@ public:
     QString last();
     QString absolutePath();
     QDateTime lastModified(QString fileName);
-    void copyTo(QString destDir, QFileInfo srcUrl, FileOpResult &result);
-    void moveTo(QString destDir, QFileInfo srcUrl, FileOpResult &result);
+    // background operations, results come via fileOp* signals
+    void copyFiles(QStringList srcPaths, QString destDir);
+    void moveFiles(QStringList srcPaths, QString destDir);
+    void trashFiles(QStringList srcPaths);
     void setDirectory(QString);
+    bool isLoading() const;
 
     void unload(int index);
 
@@ -74,7 +68,12 @@ signals:
     void fileAdded(QString fileName);
     void fileModified(QString fileName);
     void fileModifiedInternal(QString fileName);
+    void filesAdded(QStringList fileNames);
+    void filesRemoved(QStringList fileNames, QList<int> indexes);
+    void filesModified(QStringList fileNames);
     void loaded(QString);
+    void filesAppended(int index, int count);
+    void listingFinished();
     void sortingChanged(SortingMode);
     void indexChanged(int oldIndex, int index);
     // returns current item
@@ -84,11 +83,17 @@ signals:
     void generateThumbnails(QList<int> indexes, int size, bool, bool);
     void thumbnailReady(std::shared_ptr<Thumbnail>);
 
+    void fileOpItemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result);
+    void fileOpProgress(FileOpType type, int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal);
+    void fileOpFinished(FileOpType type, int count, int failed, FileOpResult lastError);
+
 private:
     DirectoryManager dirManager;
+    CompressedCache compressedCache;
     Loader loader;
     Cache cache;
     Thumbnailer *thumbnailer;
+    FileOpQueue fileOps;
     void trimCache(QString currentFileName);
 
 private slots:
@@ -98,4 +103,7 @@ private slots:
     void onFileRemoved(QString fileName, int index);
     void onFileRenamed(QString from, int indexFrom, QString to, int indexTo);
     void onFileModified(QString fileName);
+    void onFilesRemoved(QStringList fileNames, QList<int> indexes);
+    void onFilesModified(QStringList fileNames);
+    void onFileOpItemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result);
 };
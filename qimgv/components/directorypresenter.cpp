@@ -6,9 +6,13 @@ DirectoryPresenter::DirectoryPresenter(QObject *parent) : QObject(parent) {
 void DirectoryPresenter::unsetModel() {
     disconnect(model.get(), &DirectoryModel::fileRemoved,    this, &DirectoryPresenter::onFileRemoved);
     disconnect(model.get(), &DirectoryModel::fileAdded,      this, &DirectoryPresenter::onFileAdded);
+    disconnect(model.get(), &DirectoryModel::filesAppended,  this, &DirectoryPresenter::onFilesAppended);
     disconnect(model.get(), &DirectoryModel::fileModified,   this, &DirectoryPresenter::onFileModified);
     disconnect(model.get(), &DirectoryModel::fileModifiedInternal,   this, &DirectoryPresenter::onFileModified);
     disconnect(model.get(), &DirectoryModel::fileRenamed,    this, &DirectoryPresenter::onFileRenamed);
+    disconnect(model.get(), &DirectoryModel::filesAdded,     this, &DirectoryPresenter::onFilesAdded);
+    disconnect(model.get(), &DirectoryModel::filesRemoved,   this, &DirectoryPresenter::onFilesRemoved);
+    disconnect(model.get(), &DirectoryModel::filesModified,  this, &DirectoryPresenter::onFilesModified);
     disconnect(model.get(), &DirectoryModel::thumbnailReady, this, &DirectoryPresenter::onThumbnailReady);
     disconnect(this, &DirectoryPresenter::generateThumbnails, model.get(), &DirectoryModel::generateThumbnails);
     model = nullptr;
@@ -50,9 +54,13 @@ void DirectoryPresenter::setModel(std::shared_ptr<DirectoryModel> newModel) {
     // filesystem changes
     connect(model.get(), &DirectoryModel::fileRemoved,    this, &DirectoryPresenter::onFileRemoved);
     connect(model.get(), &DirectoryModel::fileAdded,      this, &DirectoryPresenter::onFileAdded);
+    connect(model.get(), &DirectoryModel::filesAppended,  this, &DirectoryPresenter::onFilesAppended);
     connect(model.get(), &DirectoryModel::fileModified,   this, &DirectoryPresenter::onFileModified);
     connect(model.get(), &DirectoryModel::fileModifiedInternal,   this, &DirectoryPresenter::onFileModified);
     connect(model.get(), &DirectoryModel::fileRenamed,    this, &DirectoryPresenter::onFileRenamed);
+    connect(model.get(), &DirectoryModel::filesAdded,     this, &DirectoryPresenter::onFilesAdded);
+    connect(model.get(), &DirectoryModel::filesRemoved,   this, &DirectoryPresenter::onFilesRemoved);
+    connect(model.get(), &DirectoryModel::filesModified,  this, &DirectoryPresenter::onFilesModified);
     connect(model.get(), &DirectoryModel::thumbnailReady, this, &DirectoryPresenter::onThumbnailReady);
     connect(this, &DirectoryPresenter::generateThumbnails, model.get(), &DirectoryModel::generateThumbnails);
 }
@@ -120,6 +128,14 @@ void DirectoryPresenter::onFileAdded(QString fileName) {
         thumbPanel->insertItem(index);
 }
 
+// streamed while the directory is being listed
+void DirectoryPresenter::onFilesAppended(int index, int count) {
+    if(folderView)
+        folderView->insertItems(index, count);
+    if(thumbPanel)
+        thumbPanel->insertItems(index, count);
+}
+
 void DirectoryPresenter::onFileModified(QString fileName) {
     int index = model->indexOf(fileName);
     if(folderView)
@@ -128,6 +144,31 @@ void DirectoryPresenter::onFileModified(QString fileName) {
         thumbPanel->reloadItem(index);
 }
 
+// one layout update per view for the whole batch
+void DirectoryPresenter::onFilesAdded(QStringList fileNames) {
+    QList<int> indexes;
+    for(auto &fileName : fileNames)
+        indexes.append(model->indexOf(fileName));
+    std::sort(indexes.begin(), indexes.end());
+    if(folderView)
+        folderView->insertItems(indexes);
+    if(thumbPanel)
+        thumbPanel->insertItems(indexes);
+}
+
+void DirectoryPresenter::onFilesRemoved(QStringList fileNames, QList<int> indexes) {
+    Q_UNUSED(fileNames)
+    if(folderView)
+        folderView->removeItems(indexes);
+    if(thumbPanel)
+        thumbPanel->removeItems(indexes);
+}
+
+void DirectoryPresenter::onFilesModified(QStringList fileNames) {
+    for(auto &fileName : fileNames)
+        onFileModified(fileName);
+}
+
 void DirectoryPresenter::onThumbnailReady(std::shared_ptr<Thumbnail> thumb) {
     int index = model->indexOf(thumb->name());
     if(folderView)
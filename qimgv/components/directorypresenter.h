@@ -24,7 +24,11 @@ public:
     void onFileRemoved(QString fileName, int index);
     void onFileRenamed(QString from, int indexFrom, QString to, int indexTo);
     void onFileAdded(QString fileName);
+    void onFilesAppended(int index, int count);
     void onFileModified(QString fileName);
+    void onFilesAdded(QStringList fileNames);
+    void onFilesRemoved(QStringList fileNames, QList<int> indexes);
+    void onFilesModified(QStringList fileNames);
 
 signals:
     void generateThumbnails(QList<int>, int, bool, bool);
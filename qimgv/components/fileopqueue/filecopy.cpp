@@ -0,0 +1,167 @@
+#include "filecopy.h"
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <cerrno>
+#include <vector>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#define USE_COPY_FILE_RANGE
+#endif
+#ifndef RENAME_NOREPLACE
+#define RENAME_NOREPLACE (1 << 0)
+#endif
+#endif
+
+#ifdef __linux__
+static const size_t CHUNK_SIZE = 8 * 1024 * 1024;
+static const size_t BUFFER_SIZE = 1024 * 1024;
+
+// plain read / write, for when the kernel can't copy between these two
+static ssize_t copyChunk(int in, int out, std::vector<char> &buffer) {
+    if(buffer.empty())
+        buffer.resize(BUFFER_SIZE);
+    ssize_t bytesRead = read(in, buffer.data(), buffer.size());
+    if(bytesRead <= 0)
+        return bytesRead;
+    ssize_t written = 0;
+    while(written < bytesRead) {
+        ssize_t n = write(out, buffer.data() + written, static_cast<size_t>(bytesRead - written));
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+        written += n;
+    }
+    return bytesRead;
+}
+
+static bool copyData(int in, int out, quint64 size, const CopyProgress &progress, std::error_code &ec) {
+#ifdef FICLONE
+    // shares the extents on btrfs / xfs, nothing is copied at all
+    if(ioctl(out, FICLONE, in) == 0)
+        return !progress || progress(size);
+#endif
+    std::vector<char> buffer;
+    quint64 done = 0;
+#ifdef USE_COPY_FILE_RANGE
+    bool useRange = true;
+#else
+    bool useRange = false;
+#endif
+    while(true) {
+        ssize_t n;
+#ifdef USE_COPY_FILE_RANGE
+        if(useRange) {
+            n = copy_file_range(in, nullptr, out, nullptr, CHUNK_SIZE, 0);
+            // not supported for this pair of files (older kernels, some fuse mounts)
+            if(n < 0 && done == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) {
+                useRange = false;
+                continue;
+            }
+        } else
+#endif
+        {
+            n = copyChunk(in, out, buffer);
+        }
+        if(n < 0) {
+            if(errno == EINTR)
+                continue;
+            ec = std::error_code(errno, std::generic_category());
+            return false;
+        }
+        if(n == 0)
+            return true;
+        done += static_cast<quint64>(n);
+        if(progress && !progress(done)) {
+            ec = std::make_error_code(std::errc::operation_canceled);
+            return false;
+        }
+    }
+}
+#endif
+
+bool copyFile(const std::filesystem::path &src, const std::filesystem::path &dest,
+              const CopyProgress &progress, std::error_code &ec) {
+#ifdef __linux__
+    int in = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if(in == -1) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    struct stat sb;
+    if(fstat(in, &sb) != 0) {
+        ec = std::error_code(errno, std::generic_category());
+        close(in);
+        return false;
+    }
+    // O_EXCL: never overwrite
+    int out = open(dest.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, sb.st_mode & 0777);
+    if(out == -1) {
+        ec = std::error_code(errno, std::generic_category());
+        close(in);
+        return false;
+    }
+    bool ok = copyData(in, out, static_cast<quint64>(sb.st_size), progress, ec);
+    close(in);
+    if(close(out) != 0 && ok) {
+        ec = std::error_code(errno, std::generic_category());
+        ok = false;
+    }
+    if(!ok)
+        unlink(dest.c_str());
+    return ok;
+#else
+    std::error_code tmp;
+    if(std::filesystem::exists(dest, tmp)) {
+        ec = std::make_error_code(std::errc::file_exists);
+        return false;
+    }
+    if(!std::filesystem::copy_file(src, dest, std::filesystem::copy_options::none, ec)) {
+        std::filesystem::remove(dest, tmp);
+        return false;
+    }
+    if(progress)
+        progress(std::filesystem::file_size(dest, tmp));
+    return true;
+#endif
+}
+
+bool moveFile(const std::filesystem::path &src, const std::filesystem::path &dest, std::error_code &ec) {
+#ifdef __linux__
+#ifdef SYS_renameat2
+    if(syscall(SYS_renameat2, AT_FDCWD, src.c_str(), AT_FDCWD, dest.c_str(), RENAME_NOREPLACE) == 0)
+        return true;
+    // older kernels, and filesystems which can't do it atomically
+    if(errno != EINVAL && errno != ENOSYS) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+#endif
+    // link() fails with EEXIST rather than replacing dest
+    if(link(src.c_str(), dest.c_str()) == 0) {
+        if(unlink(src.c_str()) == 0)
+            return true;
+        ec = std::error_code(errno, std::generic_category());
+        unlink(dest.c_str());
+        return false;
+    }
+    // no hard links here (fat, some fuse mounts), nothing atomic is left
+    if(errno != EPERM && errno != EOPNOTSUPP && errno != ENOSYS) {
+        ec = std::error_code(errno, std::generic_category());
+        return false;
+    }
+#endif
+    std::error_code tmp;
+    if(std::filesystem::exists(dest, tmp)) {
+        ec = std::make_error_code(std::errc::file_exists);
+        return false;
+    }
+    std::filesystem::rename(src, dest, ec);
+    return !ec;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QtGlobal>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+
+// Gets the number of bytes copied so far. Returning false cancels the copy.
+typedef std::function<bool(quint64)> CopyProgress;
+
+// Copies src into a new file at dest; fails if dest already exists.
+// On linux this tries a reflink first, then copy_file_range(), so the data
+// doesn't pass through userspace. std::filesystem::copy_file() elsewhere.
+// A partially written dest is removed on failure.
+bool copyFile(const std::filesystem::path &src, const std::filesystem::path &dest,
+              const CopyProgress &progress, std::error_code &ec);
+
+// Renames src to dest; fails if dest already exists, even if it shows up
+// in the meantime. On linux that is renameat2(RENAME_NOREPLACE), or
+// link() + unlink() on filesystems without it. cross_device_link in ec
+// means src has to be copied instead.
+bool moveFile(const std::filesystem::path &src, const std::filesystem::path &dest, std::error_code &ec);
@@ -0,0 +1,119 @@
+#include "fileopjob.h"
+#include "components/directorymanager/directorymanager.h"
+
+FileOpJob::FileOpJob(FileOpType _type, QStringList _srcPaths, QString _destDir,
+                     std::shared_ptr<std::atomic<bool>> _cancelled)
+    : type(_type),
+      srcPaths(_srcPaths),
+      destDir(_destDir),
+      cancelled(_cancelled),
+      filesDone(0),
+      bytesDone(0),
+      bytesTotal(0)
+{
+}
+
+void FileOpJob::run() {
+    QList<QFileInfo> files;
+    for(auto &path : srcPaths) {
+        files.append(QFileInfo(path));
+        bytesTotal += files.last().size();
+    }
+    int failed = 0;
+    FileOpResult lastError = FileOpResult::SUCCESS;
+    progressTimer.start();
+    for(auto &src : files) {
+        if(cancelled->load())
+            break;
+        QString destPath;
+        FileOpResult result = check(src, destPath);
+        if(result == FileOpResult::SUCCESS) {
+            if(type == FILEOP_COPY)
+                result = copy(src.absoluteFilePath(), destPath, src.size());
+            else if(type == FILEOP_MOVE)
+                result = move(src.absoluteFilePath(), destPath, src.size());
+            else
+                result = trash(src.absoluteFilePath());
+        }
+        if(result != FileOpResult::SUCCESS) {
+            failed++;
+            lastError = result;
+        }
+        filesDone++;
+        emit itemFinished(type, src.absoluteFilePath(), destPath, result);
+        reportProgress(0);
+    }
+    emit finished(type, filesDone, failed, lastError);
+}
+
+FileOpResult FileOpJob::check(const QFileInfo &src, QString &destPath) const {
+    if(!src.exists())
+        return FileOpResult::SOURCE_DOES_NOT_EXIST;
+    if(type == FILEOP_TRASH)
+        return src.isWritable() ? FileOpResult::SUCCESS : FileOpResult::SOURCE_NOT_WRITABLE;
+    QFileInfo location(destDir);
+    if(src.absolutePath() == location.absoluteFilePath())
+        return FileOpResult::COPY_TO_SAME_DIR;
+    if(!location.exists())
+        return FileOpResult::DESTINATION_DOES_NOT_EXIST;
+    if(!location.isWritable())
+        return FileOpResult::DESTINATION_NOT_WRITABLE;
+    destPath = location.absoluteFilePath() + "/" + src.fileName();
+    if(QFileInfo::exists(destPath))
+        return FileOpResult::DESTINATION_FILE_EXISTS;
+    return FileOpResult::SUCCESS;
+}
+
+FileOpResult FileOpJob::copy(const QString &srcPath, const QString &destPath, qint64 size) {
+    qint64 base = bytesDone;
+    std::error_code ec;
+    bool ok = copyFile(toStdString(srcPath), toStdString(destPath), [&](quint64 copied) {
+        reportProgress(base + static_cast<qint64>(copied) - bytesDone);
+        return !cancelled->load();
+    }, ec);
+    // don't let a short read throw the total off
+    bytesDone = base + size;
+    if(ok)
+        return FileOpResult::SUCCESS;
+    if(ec == std::errc::file_exists)
+        return FileOpResult::DESTINATION_FILE_EXISTS;
+    if(ec == std::errc::permission_denied)
+        return FileOpResult::DESTINATION_NOT_WRITABLE;
+    return FileOpResult::OTHER_ERROR;
+}
+
+// rename first, it is instant on the same filesystem
+FileOpResult FileOpJob::move(const QString &srcPath, const QString &destPath, qint64 size) {
+    std::error_code ec;
+    if(moveFile(toStdString(srcPath), toStdString(destPath), ec)) {
+        reportProgress(size);
+        return FileOpResult::SUCCESS;
+    }
+    if(ec == std::errc::file_exists)
+        return FileOpResult::DESTINATION_FILE_EXISTS;
+    if(ec == std::errc::permission_denied || ec == std::errc::operation_not_permitted)
+        return FileOpResult::SOURCE_NOT_WRITABLE;
+    if(ec != std::errc::cross_device_link)
+        return FileOpResult::OTHER_ERROR;
+    FileOpResult result = copy(srcPath, destPath, size);
+    if(result != FileOpResult::SUCCESS)
+        return result;
+    if(!QFile::remove(srcPath)) {
+        // revert, the file should not end up in both places
+        QFile::remove(destPath);
+        return FileOpResult::SOURCE_NOT_WRITABLE;
+    }
+    return FileOpResult::SUCCESS;
+}
+
+FileOpResult FileOpJob::trash(const QString &srcPath) {
+    return DirectoryManager::moveToTrash(srcPath) ? FileOpResult::SUCCESS : FileOpResult::OTHER_ERROR;
+}
+
+void FileOpJob::reportProgress(qint64 bytes) {
+    bytesDone += bytes;
+    if(progressTimer.elapsed() < PROGRESS_INTERVAL)
+        return;
+    progressTimer.restart();
+    emit progress(type, filesDone, srcPaths.count(), bytesDone, bytesTotal);
+}
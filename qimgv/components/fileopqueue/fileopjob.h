@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include <atomic>
+#include <memory>
+#include "filecopy.h"
+#include "utils/stuff.h"
+
+enum FileOpResult {
+    SUCCESS,
+    DESTINATION_FILE_EXISTS,
+    SOURCE_NOT_WRITABLE,
+    DESTINATION_NOT_WRITABLE,
+    SOURCE_DOES_NOT_EXIST,
+    DESTINATION_DOES_NOT_EXIST,
+    COPY_TO_SAME_DIR,
+    OTHER_ERROR
+};
+
+enum FileOpType {
+    FILEOP_COPY,
+    FILEOP_MOVE,
+    FILEOP_TRASH
+};
+
+Q_DECLARE_METATYPE(FileOpResult)
+Q_DECLARE_METATYPE(FileOpType)
+
+/* Copies, moves or trashes a list of files, one after another.
+ *
+ * A move is a rename() when source and destination are on the same
+ * filesystem, and a copy + remove otherwise. Every file gets its own
+ * itemFinished(); progress() is sent at most every PROGRESS_INTERVAL.
+ * Setting the cancel flag stops the job after the current file, or in the
+ * middle of a copy.
+ */
+
+class FileOpJob : public QObject, public QRunnable {
+    Q_OBJECT
+public:
+    FileOpJob(FileOpType _type, QStringList _srcPaths, QString _destDir,
+              std::shared_ptr<std::atomic<bool>> _cancelled);
+    void run();
+
+signals:
+    void itemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result);
+    void progress(FileOpType type, int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal);
+    void finished(FileOpType type, int count, int failed, FileOpResult lastError);
+
+private:
+    FileOpType type;
+    QStringList srcPaths;
+    QString destDir;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+    int filesDone;
+    qint64 bytesDone, bytesTotal;
+    QElapsedTimer progressTimer;
+    const int PROGRESS_INTERVAL = 250; // ms
+
+    FileOpResult check(const QFileInfo &src, QString &destPath) const;
+    FileOpResult copy(const QString &srcPath, const QString &destPath, qint64 size);
+    FileOpResult move(const QString &srcPath, const QString &destPath, qint64 size);
+    FileOpResult trash(const QString &srcPath);
+    void reportProgress(qint64 bytes);
+};
@@ -0,0 +1,45 @@
+#include "fileopqueue.h"
+
+FileOpQueue::FileOpQueue(QObject *parent)
+    : QObject(parent),
+      cancelled(new std::atomic<bool>(false))
+{
+    qRegisterMetaType<FileOpType>("FileOpType");
+    qRegisterMetaType<FileOpResult>("FileOpResult");
+    // one at a time, parallel copies to the same disk only seek more
+    pool.setMaxThreadCount(1);
+}
+
+FileOpQueue::~FileOpQueue() {
+    cancel();
+    pool.waitForDone();
+}
+
+void FileOpQueue::copy(QStringList srcPaths, QString destDir) {
+    start(FILEOP_COPY, srcPaths, destDir);
+}
+
+void FileOpQueue::move(QStringList srcPaths, QString destDir) {
+    start(FILEOP_MOVE, srcPaths, destDir);
+}
+
+void FileOpQueue::trash(QStringList srcPaths) {
+    start(FILEOP_TRASH, srcPaths, "");
+}
+
+void FileOpQueue::cancel() {
+    pool.clear();
+    cancelled->store(true);
+    // jobs started from now on get a new flag
+    cancelled.reset(new std::atomic<bool>(false));
+}
+
+void FileOpQueue::start(FileOpType type, QStringList srcPaths, QString destDir) {
+    if(srcPaths.isEmpty())
+        return;
+    auto job = new FileOpJob(type, srcPaths, destDir, cancelled);
+    connect(job, &FileOpJob::itemFinished, this, &FileOpQueue::itemFinished);
+    connect(job, &FileOpJob::progress, this, &FileOpQueue::progress);
+    connect(job, &FileOpJob::finished, this, &FileOpQueue::finished);
+    pool.start(job);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include "fileopjob.h"
+
+/* Runs file operations in the background, in the order they were requested.
+ * Results come back per file, so the caller can update its listing as
+ * the job goes.
+ */
+
+class FileOpQueue : public QObject {
+    Q_OBJECT
+public:
+    explicit FileOpQueue(QObject *parent = nullptr);
+    ~FileOpQueue();
+    void copy(QStringList srcPaths, QString destDir);
+    void move(QStringList srcPaths, QString destDir);
+    void trash(QStringList srcPaths);
+    // drops queued jobs and stops the running one
+    void cancel();
+
+signals:
+    void itemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result);
+    void progress(FileOpType type, int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal);
+    void finished(FileOpType type, int count, int failed, FileOpResult lastError);
+
+private:
+    QThreadPool pool;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+    void start(FileOpType type, QStringList srcPaths, QString destDir);
+};
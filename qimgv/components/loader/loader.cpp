@@ -1,13 +1,12 @@
 #include "loader.h"
 
-Loader::Loader() {
-    pool = new QThreadPool(this);
-    pool->setMaxThreadCount(2);
+Loader::Loader() : compressedCache(nullptr) {
 }
 
 void Loader::clearTasks() {
     clearPool();
-    pool->waitForDone();
+    ioScheduler->waitForDone(TASK_LOAD);
+    ioScheduler->waitForDone(TASK_PRELOAD);
 }
 
 bool Loader::isBusy() {
@@ -18,30 +17,42 @@ bool Loader::isLoading(QString path) {
     return tasks.contains(path);
 }
 
+void Loader::setCompressedCache(CompressedCache *_compressedCache) {
+    compressedCache = _compressedCache;
+}
+
 std::shared_ptr<Image> Loader::load(QString path) {
-    return ImageFactory::createImage(path);
+    std::shared_ptr<Image> image;
+    if(compressedCache)
+        image = compressedCache->restore(path);
+    if(!image)
+        image = ImageFactory::createImage(path);
+    return image;
 }
 
 // clears all buffered tasks before loading
 void Loader::loadAsyncPriority(QString path) {
     clearPool();
-    doLoadAsync(path, 1);
+    doLoadAsync(path, TASK_LOAD);
 }
 
 void Loader::loadAsync(QString path) {
-    doLoadAsync(path, 0);
+    doLoadAsync(path, TASK_PRELOAD);
 }
 
-void Loader::doLoadAsync(QString path, int priority) {
+void Loader::doLoadAsync(QString path, TaskClass taskClass) {
     if(tasks.contains(path)) {
         return;
     }
 
-    auto runnable = new LoaderRunnable(path);
+    auto runnable = new LoaderRunnable(path, compressedCache);
     runnable->setAutoDelete(false);
     tasks.insert(path, runnable);
     connect(runnable, &LoaderRunnable::finished, this, &Loader::onLoadFinished, Qt::UniqueConnection);
-    pool->start(runnable, priority);
+    if(compressedCache && compressedCache->contains(path))
+        taskScheduler->start(runnable, taskClass);
+    else
+        ioScheduler->start(path, runnable, taskClass);
 }
 
 void Loader::onLoadFinished(std::shared_ptr<Image> image, QString path) {
@@ -57,7 +68,7 @@ void Loader::clearPool() {
     QHashIterator<QString, LoaderRunnable*> i(tasks);
     while (i.hasNext()) {
         i.next();
-        if(pool->tryTake(i.value())) {
+        if(ioScheduler->tryTake(i.value())) {
             delete tasks.take(i.key());
         }
     }
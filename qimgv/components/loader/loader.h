@@ -1,7 +1,7 @@
 #pragma once
 
-#include <QThreadPool>
 #include <QtConcurrent>
+#include "components/scheduler/ioscheduler.h"
 #include "components/cache/thumbnailcache.h"
 #include "loaderrunnable.h"
 
@@ -9,6 +9,8 @@ class Loader : public QObject {
     Q_OBJECT
 public:
     explicit Loader();
+    // recently evicted images are restored from here when possible
+    void setCompressedCache(CompressedCache *_compressedCache);
     std::shared_ptr<Image> load(QString path);
     void loadAsyncPriority(QString path);
     void loadAsync(QString path);
@@ -18,9 +20,9 @@ public:
     bool isLoading(QString path);
 private:
     QHash<QString, LoaderRunnable*> tasks;
-    QThreadPool *pool;    
+    CompressedCache *compressedCache;
     void clearPool();
-    void doLoadAsync(QString path, int priority);
+    void doLoadAsync(QString path, TaskClass taskClass);
 
 signals:
     void loadFinished(std::shared_ptr<Image>);
@@ -2,13 +2,20 @@
 
 #include <QElapsedTimer>
 
-LoaderRunnable::LoaderRunnable(QString _path) : path(_path) {
+LoaderRunnable::LoaderRunnable(QString _path, CompressedCache *_compressedCache)
+    : path(_path),
+      compressedCache(_compressedCache)
+{
 }
 
 void LoaderRunnable::run() {
     //QElapsedTimer t;
     //t.start();
-    auto image = ImageFactory::createImage(path);
+    std::shared_ptr<Image> image;
+    if(compressedCache)
+        image = compressedCache->restore(path);
+    if(!image)
+        image = ImageFactory::createImage(path);
     //qDebug() << "L: " << t.elapsed();
     emit finished(image, path);
 }
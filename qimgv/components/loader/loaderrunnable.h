@@ -3,15 +3,17 @@
 #include <QObject>
 #include <QRunnable>
 #include "utils/imagefactory.h"
+#include "components/cache/compressedcache.h"
 
 class LoaderRunnable: public QObject, public QRunnable
 {
     Q_OBJECT
 public:
-    LoaderRunnable(QString _path);
+    LoaderRunnable(QString _path, CompressedCache *_compressedCache);
     void run();
 private:
     QString path;
+    CompressedCache *compressedCache;
 signals:
     void finished(std::shared_ptr<Image>, QString);
 };
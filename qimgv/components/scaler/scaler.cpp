@@ -16,8 +16,6 @@ Scaler::Scaler(Cache *_cache, QObject *parent)
       cache(_cache)
 {
     sem = new QSemaphore(1);
-    pool = new QThreadPool(this);
-    pool->setMaxThreadCount(1);
     runnable = new ScalerRunnable();
     runnable->setAutoDelete(false);
     connect(this, &Scaler::startBufferedRequest, this, &Scaler::slotStartBufferedRequest, Qt::DirectConnection);
@@ -26,6 +24,12 @@ Scaler::Scaler(Cache *_cache, QObject *parent)
     connect(this, &Scaler::acceptScalingResult, this, &Scaler::slotForwardScaledResult, Qt::QueuedConnection);
 }
 
+// expects TASK_SCALE to be finished
+Scaler::~Scaler() {
+    delete runnable;
+    delete sem;
+}
+
 void Scaler::requestScaled(ScalerRequest req) {
     sem->acquire(1);
     if(!running) {
@@ -125,5 +129,6 @@ void Scaler::slotForwardScaledResult(QImage *image, ScalerRequest req) {
 
 void Scaler::startRequest(ScalerRequest req) {
     runnable->setRequest(req);
-    pool->start(runnable);
+    // one at a time; TASK_SCALE is capped to a single worker
+    taskScheduler->start(runnable, TASK_SCALE);
 }
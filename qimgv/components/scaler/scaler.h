@@ -1,18 +1,19 @@
 #pragma once
 
 #include <QObject>
-#include <QThreadPool>
 #include <QtConcurrent>
 #include <QThread>
 #include <QMutex>
 #include "components/cache/cache.h"
 #include "scalerrequest.h"
 #include "scalerrunnable.h"
+#include "components/scheduler/taskscheduler.h"
 
 class Scaler : public QObject {
     Q_OBJECT
 public:
     explicit Scaler(Cache *_cache, QObject *parent = nullptr);
+    ~Scaler();
 
 signals:
     void scalingFinished(QPixmap* result, ScalerRequest request);
@@ -29,7 +30,6 @@ private slots:
     void slotForwardScaledResult(QImage *image, ScalerRequest req);
 
 private:
-    QThreadPool *pool;
     ScalerRunnable *runnable;
     bool buffered, running;
     clock_t currentRequestTimestamp;
@@ -0,0 +1,324 @@
+#include "ioscheduler.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <fcntl.h>
+#define USE_POSIX_STAT
+#endif
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+
+IoScheduler *ioScheduler = nullptr;
+
+// runs the original task; its lifetime is the time the read data waits in the page cache
+class IoScheduler::DecodeTask : public QRunnable {
+public:
+    DecodeTask(IoScheduler *_scheduler, QRunnable *_task, qint64 _bytes) :
+        scheduler(_scheduler),
+        task(_task),
+        bytes(_bytes),
+        owned(_task->autoDelete())
+    {
+        setAutoDelete(true);
+    }
+    ~DecodeTask() {
+        scheduler->release(this);
+        if(owned)
+            delete task;
+    }
+    void run() {
+        task->run();
+    }
+
+    IoScheduler *scheduler;
+    QRunnable *task;
+    qint64 bytes;
+    bool owned;
+};
+
+IoScheduler::IoScheduler() : decodingBytes(0), stopping(false) {
+    for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+        inFlight[i] = 0;
+        generation[i] = 0;
+    }
+    for(auto &format : QImageReader::supportedImageFormats())
+        imageSuffixes.insert(QString(format).toLower());
+    // as in Settings::supportedFormats()
+    imageSuffixes.insert("jfif");
+    for(int i = 0; i < IO_THREADS; i++)
+        workers.emplace_back(&IoScheduler::work, this);
+}
+
+IoScheduler::~IoScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+            for(auto &request : queues[i])
+                if(request.task->autoDelete())
+                    delete request.task;
+            queues[i].clear();
+        }
+    }
+    requestAdded.notify_all();
+    for(auto &worker : workers)
+        worker.join();
+}
+
+IoScheduler *IoScheduler::getInstance() {
+    if(!ioScheduler)
+        ioScheduler = new IoScheduler();
+    return ioScheduler;
+}
+
+void IoScheduler::start(QString path, QRunnable *task, TaskClass taskClass, std::function<bool()> skipRead) {
+    if(taskClass == TASK_LOAD) {
+        taskScheduler->start(task, taskClass);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queues[taskClass].push_back(Request{path, task, skipRead, generation[taskClass], false, 0, 0, 0});
+    }
+    requestAdded.notify_one();
+}
+
+bool IoScheduler::tryTake(QRunnable *task) {
+    DecodeTask *decodeTask = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+            for(auto it = queues[i].begin(); it != queues[i].end(); ++it) {
+                if(it->task == task) {
+                    queues[i].erase(it);
+                    requestDone.notify_all();
+                    return true;
+                }
+            }
+        }
+        decodeTask = decoding.value(task, nullptr);
+        if(!decodeTask || !taskScheduler->tryTake(decodeTask))
+            decodeTask = nullptr;
+    }
+    if(decodeTask) {
+        // the caller gets the task back
+        decodeTask->owned = false;
+        delete decodeTask;
+        return true;
+    }
+    return taskScheduler->tryTake(task);
+}
+
+void IoScheduler::clear(TaskClass taskClass) {
+    std::deque<Request> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        removed.swap(queues[taskClass]);
+        generation[taskClass]++;
+    }
+    requestDone.notify_all();
+    for(auto &request : removed)
+        if(request.task->autoDelete())
+            delete request.task;
+    taskScheduler->clear(taskClass);
+}
+
+void IoScheduler::waitForDone(TaskClass taskClass) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        requestDone.wait(lock, [&]() {
+            return queues[taskClass].empty() && inFlight[taskClass] == 0;
+        });
+    }
+    taskScheduler->waitForDone(taskClass);
+}
+
+void IoScheduler::release(DecodeTask *decodeTask) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        decodingBytes -= decodeTask->bytes;
+        auto it = decoding.find(decodeTask->task);
+        if(it != decoding.end() && it.value() == decodeTask)
+            decoding.erase(it);
+    }
+    requestAdded.notify_all();
+}
+
+int IoScheduler::maxReading(StorageType type) const {
+    if(type == STORAGE_HDD)
+        return 1;
+    if(type == STORAGE_NETWORK)
+        return NETWORK_READERS;
+    return IO_THREADS;
+}
+
+// expects the mutex to be locked
+// requests not looked up yet go first, that part isn't limited per device
+bool IoScheduler::takeNext(Request &request, TaskClass &taskClass) {
+    for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+        bool canRead = i < TASK_THUMBNAIL || decodingBytes < READ_AHEAD_BYTES;
+        auto &queue = queues[i];
+        auto best = queue.end();
+        quint64 bestDistance = 0;
+        for(auto it = queue.begin(); it != queue.end(); ++it) {
+            if(!it->located) {
+                best = it;
+                break;
+            }
+            if(!canRead)
+                continue;
+            Device device = devices.value(it->device);
+            if(device.reading >= maxReading(device.type))
+                continue;
+            if(device.type != STORAGE_HDD) {
+                best = it;
+                break;
+            }
+            // elevator: inodes behind the last one wrap around to the end
+            quint64 distance = it->inode - device.lastInode;
+            if(best == queue.end() || distance < bestDistance) {
+                best = it;
+                bestDistance = distance;
+            }
+        }
+        if(best == queue.end())
+            continue;
+        request = *best;
+        queue.erase(best);
+        taskClass = static_cast<TaskClass>(i);
+        if(request.located)
+            devices[request.device].lastInode = request.inode;
+        return true;
+    }
+    return false;
+}
+
+// expects the mutex to be locked
+void IoScheduler::forward(const Request &request, TaskClass taskClass, bool wasRead) {
+    if(!wasRead) {
+        taskScheduler->start(request.task, taskClass);
+        return;
+    }
+    auto decodeTask = new DecodeTask(this, request.task, request.bytes);
+    decoding.insert(request.task, decodeTask);
+    decodingBytes += request.bytes;
+    taskScheduler->start(decodeTask, taskClass);
+}
+
+void IoScheduler::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!stopping) {
+        Request request;
+        TaskClass taskClass;
+        if(!takeNext(request, taskClass)) {
+            requestAdded.wait(lock);
+            continue;
+        }
+        inFlight[taskClass]++;
+        bool wasRead = false;
+        bool queued = false;
+        if(!request.located) {
+            lock.unlock();
+            bool skip = !readsAhead(request.path) || (request.skipRead && request.skipRead());
+            if(!skip)
+                locate(request);
+            lock.lock();
+            if(!skip && !devices.contains(request.device)) {
+                lock.unlock();
+                Device device{detect(request.path, request.device), 0, 0};
+                lock.lock();
+                devices.insert(request.device, device);
+            }
+            // ssd reads aren't gated, the decoder reads the file itself
+            if(!skip && devices.value(request.device).type != STORAGE_SSD &&
+               request.generation == generation[taskClass])
+            {
+                request.located = true;
+                queues[taskClass].push_back(request);
+                queued = true;
+            }
+        } else {
+            devices[request.device].reading++;
+            lock.unlock();
+            read(request.path, request.bytes);
+            lock.lock();
+            devices[request.device].reading--;
+            wasRead = true;
+        }
+        if(!queued) {
+            if(request.generation == generation[taskClass]) {
+                forward(request, taskClass, wasRead);
+            } else if(request.task->autoDelete()) {
+                lock.unlock();
+                delete request.task;
+                lock.lock();
+            }
+        }
+        // before inFlight[] drops, so waitForDone() finds the task there
+        inFlight[taskClass]--;
+        requestAdded.notify_all();
+        requestDone.notify_all();
+    }
+}
+
+// the data itself is thrown away; the decoder reads it again from the page cache
+void IoScheduler::read(QString path, qint64 bytes) {
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return;
+#ifdef __linux__
+    posix_fadvise(file.handle(), 0, bytes, POSIX_FADV_SEQUENTIAL);
+#endif
+    std::vector<char> buffer(static_cast<size_t>(READ_CHUNK));
+    while(bytes > 0) {
+        qint64 n = file.read(buffer.data(), qMin(READ_CHUNK, bytes));
+        if(n <= 0)
+            break;
+        bytes -= n;
+    }
+}
+
+void IoScheduler::locate(Request &request) {
+#ifdef USE_POSIX_STAT
+    struct stat sb;
+    if(stat(QFile::encodeName(request.path).constData(), &sb) == 0) {
+        request.device = static_cast<quint64>(sb.st_dev);
+        request.inode = static_cast<quint64>(sb.st_ino);
+        request.bytes = static_cast<qint64>(sb.st_size);
+    }
+#else
+    QFileInfo info(request.path);
+    request.device = qHash(info.absolutePath());
+    request.bytes = info.size();
+#endif
+    request.bytes = qMin(request.bytes, READ_LIMIT);
+}
+
+// decoders of other formats don't read the file front to back
+bool IoScheduler::readsAhead(const QString &path) const {
+    return imageSuffixes.contains(QFileInfo(path).suffix().toLower());
+}
+
+StorageType IoScheduler::detect(QString path, quint64 device) {
+    QStorageInfo storage(QFileInfo(path).absolutePath());
+    QByteArray fsType = storage.fileSystemType().toLower();
+    static const QList<QByteArray> networkTypes = {
+        "nfs", "nfs4", "cifs", "smbfs", "smb3", "9p", "afs", "ceph", "glusterfs",
+        "fuse.sshfs", "fuse.rclone", "fuse.smbnetfs", "fuse.glusterfs"
+    };
+    if(networkTypes.contains(fsType))
+        return STORAGE_NETWORK;
+#ifdef __linux__
+    // partitions keep the flag on the parent device
+    QString sysfs = QString("/sys/dev/block/%1:%2").arg(major(device)).arg(minor(device));
+    QFile rotational(sysfs + "/queue/rotational");
+    if(!rotational.exists())
+        rotational.setFileName(sysfs + "/../queue/rotational");
+    if(rotational.open(QIODevice::ReadOnly) && rotational.read(1) == "1")
+        return STORAGE_HDD;
+#else
+    Q_UNUSED(device);
+#endif
+    return STORAGE_SSD;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <QRunnable>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QStorageInfo>
+#include <QImageReader>
+#include <QSet>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "components/scheduler/taskscheduler.h"
+
+enum StorageType {
+    STORAGE_SSD,
+    STORAGE_HDD,
+    STORAGE_NETWORK
+};
+
+/* Read stage in front of the TaskScheduler, for storage where the order
+ * and the number of parallel reads matter.
+ *
+ * A task started here is queued by path. An i/o thread looks the file up
+ * (device, inode, size), reads it into the page cache and only then hands
+ * the task to the TaskScheduler, where the decoder finds the data in
+ * memory. Nothing here touches the disk on the calling thread. Only image
+ * files are read ahead; anything else (videos, where the grabber seeks)
+ * goes straight to the TaskScheduler. Reads per device:
+ *   hdd      one at a time, closest inode ahead of the last one first
+ *   network  a few at a time, with sequential readahead
+ *   ssd      not gated, tasks go straight to the TaskScheduler
+ * TASK_LOAD skips this stage, the image on screen never waits behind reads
+ * done for thumbnails or preloads.
+ * Decoding runs with whatever parallelism the TaskScheduler allows.
+ * Requests cleared while being looked up or read are dropped before decode.
+ * Thumbnails and preloads stop reading ahead once READ_AHEAD_BYTES are
+ * waiting to be decoded.
+ */
+
+class IoScheduler {
+public:
+    static IoScheduler *getInstance();
+    ~IoScheduler();
+
+    // skipRead runs on the i/o thread; true sends the task straight to decoding
+    void start(QString path, QRunnable *task, TaskClass taskClass,
+               std::function<bool()> skipRead = nullptr);
+    // these cover the TaskScheduler side as well
+    bool tryTake(QRunnable *task);
+    void clear(TaskClass taskClass);
+    void waitForDone(TaskClass taskClass);
+
+private:
+    IoScheduler();
+    class DecodeTask;
+    struct Request {
+        QString path;
+        QRunnable *task;
+        std::function<bool()> skipRead;
+        int generation;
+        bool located;
+        quint64 device, inode;
+        qint64 bytes;
+    };
+    struct Device {
+        StorageType type;
+        int reading;
+        quint64 lastInode;
+    };
+
+    void work();
+    bool takeNext(Request &request, TaskClass &taskClass);
+    void forward(const Request &request, TaskClass taskClass, bool wasRead);
+    void read(QString path, qint64 bytes);
+    void release(DecodeTask *decodeTask);
+    int maxReading(StorageType type) const;
+    void locate(Request &request);
+    bool readsAhead(const QString &path) const;
+    StorageType detect(QString path, quint64 device);
+
+    std::mutex mutex;
+    std::condition_variable requestAdded, requestDone;
+    std::deque<Request> queues[TASK_CLASS_COUNT];
+    // being looked up or read
+    int inFlight[TASK_CLASS_COUNT];
+    // bumped by clear(), requests taken before that are dropped
+    int generation[TASK_CLASS_COUNT];
+    QHash<quint64, Device> devices;
+    // file suffixes of the formats read ahead
+    QSet<QString> imageSuffixes;
+    // read, waiting for or in decoding
+    QHash<QRunnable*, DecodeTask*> decoding;
+    qint64 decodingBytes;
+    std::vector<std::thread> workers;
+    bool stopping;
+
+    const int IO_THREADS = 4;
+    const int NETWORK_READERS = 3;
+    const qint64 READ_CHUNK = 1024 * 1024;
+    // per file; a video thumbnail only needs the beginning
+    const qint64 READ_LIMIT = 64 * 1024 * 1024;
+    const qint64 READ_AHEAD_BYTES = 256 * 1024 * 1024;
+};
+
+extern IoScheduler *ioScheduler;
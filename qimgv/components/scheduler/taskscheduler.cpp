@@ -0,0 +1,158 @@
+#include "taskscheduler.h"
+
+TaskScheduler *taskScheduler = nullptr;
+
+namespace {
+
+class FunctionTask : public QRunnable {
+public:
+    FunctionTask(std::function<void()> _function) : function(_function) {
+    }
+    void run() {
+        function();
+    }
+private:
+    std::function<void()> function;
+};
+
+}
+
+TaskScheduler::TaskScheduler()
+    : threadCount(qMax(QThread::idealThreadCount(), 2)),
+      stopping(false)
+{
+    for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+        active[i] = 0;
+        maxActive[i] = 1;
+    }
+    maxActive[TASK_LOAD] = 2;
+    workers.reserve(static_cast<size_t>(threadCount));
+    for(int i = 0; i < threadCount; i++)
+        workers.emplace_back(&TaskScheduler::work, this);
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+            for(auto task : queues[i])
+                if(task->autoDelete())
+                    delete task;
+            queues[i].clear();
+        }
+    }
+    taskAdded.notify_all();
+    for(auto &worker : workers)
+        worker.join();
+}
+
+TaskScheduler *TaskScheduler::getInstance() {
+    if(!taskScheduler)
+        taskScheduler = new TaskScheduler();
+    return taskScheduler;
+}
+
+int TaskScheduler::workerCount() const {
+    return threadCount;
+}
+
+void TaskScheduler::setMaxActive(TaskClass taskClass, int count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        maxActive[taskClass] = qMax(count, 1);
+    }
+    taskAdded.notify_all();
+}
+
+int TaskScheduler::maxActiveCount(TaskClass taskClass) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return maxActive[taskClass];
+}
+
+void TaskScheduler::start(QRunnable *task, TaskClass taskClass) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queues[taskClass].push_back(task);
+    }
+    taskAdded.notify_one();
+}
+
+void TaskScheduler::start(std::function<void()> function, TaskClass taskClass) {
+    start(new FunctionTask(function), taskClass);
+}
+
+bool TaskScheduler::tryTake(QRunnable *task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+        for(auto it = queues[i].begin(); it != queues[i].end(); ++it) {
+            if(*it == task) {
+                queues[i].erase(it);
+                taskDone.notify_all();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::clear(TaskClass taskClass) {
+    std::deque<QRunnable*> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        removed.swap(queues[taskClass]);
+    }
+    taskDone.notify_all();
+    for(auto task : removed)
+        if(task->autoDelete())
+            delete task;
+}
+
+void TaskScheduler::waitForDone(TaskClass taskClass) {
+    std::unique_lock<std::mutex> lock(mutex);
+    taskDone.wait(lock, [&]() {
+        return queues[taskClass].empty() && active[taskClass] == 0;
+    });
+}
+
+// expects the mutex to be locked
+bool TaskScheduler::takeNext(QRunnable *&task, TaskClass &taskClass) {
+    int lowPriorityActive = 0;
+    for(int i = TASK_THUMBNAIL; i < TASK_CLASS_COUNT; i++)
+        lowPriorityActive += active[i];
+    for(int i = 0; i < TASK_CLASS_COUNT; i++) {
+        if(queues[i].empty() || active[i] >= maxActive[i])
+            continue;
+        if(i >= TASK_THUMBNAIL && lowPriorityActive >= workerCount() - 1)
+            return false;
+        task = queues[i].front();
+        queues[i].pop_front();
+        taskClass = static_cast<TaskClass>(i);
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while(!stopping) {
+        QRunnable *task = nullptr;
+        TaskClass taskClass;
+        if(!takeNext(task, taskClass)) {
+            taskAdded.wait(lock);
+            continue;
+        }
+        active[taskClass]++;
+        lock.unlock();
+        // read before run(), the task may delete itself otherwise
+        bool autoDelete = task->autoDelete();
+        task->run();
+        if(autoDelete)
+            delete task;
+        lock.lock();
+        active[taskClass]--;
+        // a freed slot may let a capped class run
+        taskAdded.notify_all();
+        taskDone.notify_all();
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QRunnable>
+#include <QThread>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// in order of priority
+enum TaskClass {
+    TASK_LOAD,          // the image on screen
+    TASK_SCALE,         // scaling of the image on screen
+    TASK_THUMBNAIL,     // thumbnails in view
+    TASK_PRELOAD,       // images next to the current one
+    TASK_BACKGROUND,    // cache compression and such
+    TASK_CLASS_COUNT
+};
+
+/* One set of worker threads for loading, scaling, thumbnails and
+ * background work, instead of a thread pool per component.
+ *
+ * A worker that becomes free always takes the oldest task of the highest
+ * priority class that is below its concurrency cap. Running tasks are not
+ * interrupted, so a click waits at most for one task to finish.
+ * Thumbnails, preloads and background tasks together never take the last
+ * worker; it stays free for the image on screen.
+ */
+
+class TaskScheduler {
+public:
+    static TaskScheduler *getInstance();
+    ~TaskScheduler();
+
+    // autoDelete() is honored the same way QThreadPool does
+    void start(QRunnable *task, TaskClass taskClass);
+    void start(std::function<void()> function, TaskClass taskClass);
+    // removes a queued task without deleting it
+    bool tryTake(QRunnable *task);
+    // removes queued tasks of a class, deleting the autoDelete ones
+    void clear(TaskClass taskClass);
+    // until nothing of this class is queued or running
+    void waitForDone(TaskClass taskClass);
+    void setMaxActive(TaskClass taskClass, int count);
+    int maxActiveCount(TaskClass taskClass);
+    int workerCount() const;
+
+private:
+    TaskScheduler();
+    void work();
+    bool takeNext(QRunnable *&task, TaskClass &taskClass);
+
+    std::mutex mutex;
+    std::condition_variable taskAdded, taskDone;
+    std::deque<QRunnable*> queues[TASK_CLASS_COUNT];
+    int active[TASK_CLASS_COUNT];
+    int maxActive[TASK_CLASS_COUNT];
+    const int threadCount;
+    std::vector<std::thread> workers;
+    bool stopping;
+};
+
+extern TaskScheduler *taskScheduler;
@@ -2,17 +2,12 @@
 
 Thumbnailer::Thumbnailer(DirectoryManager *_dm) : dm(_dm) {
     cache = new ThumbnailCache();
-    pool = new QThreadPool(this);
-    int threads = settings->thumbnailerThreadCount();
-    int globalThreads = QThreadPool::globalInstance()->maxThreadCount();
-    if(threads > globalThreads)
-        threads = globalThreads;
-    pool->setMaxThreadCount(threads);
+    taskScheduler->setMaxActive(TASK_THUMBNAIL, settings->thumbnailerThreadCount());
 }
 
 void Thumbnailer::clearTasks() {
-    pool->clear();
-    pool->waitForDone();
+    ioScheduler->clear(TASK_THUMBNAIL);
+    ioScheduler->waitForDone(TASK_THUMBNAIL);
 }
 
 std::shared_ptr<Thumbnail> Thumbnailer::getThumbnail(QString filePath, int size) {
@@ -20,7 +15,7 @@ std::shared_ptr<Thumbnail> Thumbnailer::getThumbnail(QString filePath, int size)
 }
 
 void Thumbnailer::generateThumbnails(QList<int> indexes, int size, bool crop, bool force) {
-    pool->clear();
+    ioScheduler->clear(TASK_THUMBNAIL);
     for(int i = 0; i < indexes.count(); i++) {
         if(!dm->checkRange(indexes[i]))
             continue;
@@ -36,7 +31,16 @@ void Thumbnailer::startThumbnailerThread(QString filePath, int size, bool crop,
     connect(runnable, &ThumbnailerRunnable::taskStart, this, &Thumbnailer::onTaskStart);
     connect(runnable, &ThumbnailerRunnable::taskEnd, this, &Thumbnailer::onTaskEnd);
     runnable->setAutoDelete(true);
-    pool->start(runnable);
+    // a cached thumbnail doesn't touch the original file
+    std::function<bool()> cached;
+    if(settings->useThumbnailCache() && !force) {
+        ThumbnailCache *thumbnailCache = cache;
+        QString id = ThumbnailerRunnable::generateIdString(filePath, size, crop);
+        cached = [thumbnailCache, id]() {
+            return thumbnailCache->exists(id);
+        };
+    }
+    ioScheduler->start(filePath, runnable, TASK_THUMBNAIL, cached);
 }
 
 void Thumbnailer::onTaskStart(QString path, int size) {
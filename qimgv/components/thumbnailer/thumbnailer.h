@@ -1,11 +1,11 @@
 #pragma once
 
-#include <QThreadPool>
 #include <QtConcurrent>
 #include "components/directorymanager/directorymanager.h"
 #include "components/thumbnailer/thumbnailerrunnable.h"
 #include "components/cache/thumbnailcache.h"
 #include "components/cache/cache.h"
+#include "components/scheduler/ioscheduler.h"
 #include "settings.h"
 
 class Thumbnailer : public QObject
@@ -21,7 +21,6 @@ public slots:
 
 private:
     ThumbnailCache *cache;
-    QThreadPool *pool;
     void startThumbnailerThread(QString filePath, int size, bool crop, bool force);
     DirectoryManager *dm;
     QMultiMap<QString, int> runningTasks;
@@ -135,40 +135,51 @@ std::pair<QImage*, QSize> ThumbnailerRunnable::createThumbnail(QUrl path, const
 }
 
 std::pair<QImage*, QSize> ThumbnailerRunnable::createVideoThumbnail(QUrl path, int size, bool squared) {
-    QImageReader reader;
-    QString tmpFilePath = settings->tmpDir() + path.fileName() + ".png";
-    QString tmpFilePathEsc = tmpFilePath;
-    tmpFilePathEsc.replace("%", "%%");
-    QString command = "\"" + settings->mpvBinary() + "\" --start=30% --frames=1 --aid=no --sid=no --no-config --load-scripts=no --no-terminal --o=\"" + tmpFilePathEsc + "\" \"" + path.toString() + "\"";
-    QProcess process;
-    process.start(command);
-    process.waitForFinished(8000);
-    process.close();
+    QImage frame;
+    if(VideoFrameGrabber::isAvailable())
+        frame = VideoFrameGrabber::grabFrame(path.toString(), 30);
+    else
+        frame = grabVideoFrameExternal(path);
 
-    reader.setFileName(tmpFilePath);
-    reader.setFormat("png");
     Qt::AspectRatioMode ARMode = squared?
                 (Qt::KeepAspectRatioByExpanding):(Qt::KeepAspectRatio);
+    QSize originalSize = frame.size();
     QImage *result = nullptr;
+    if(frame.isNull())
+        return std::make_pair(new QImage(), originalSize);
 
     // scale & crop
-    QSize scaledSize = reader.size().scaled(size, size, ARMode);
-    reader.setScaledSize(scaledSize);
+    QSize scaledSize = frame.size().scaled(size, size, ARMode);
+    QImage scaled = frame.scaled(scaledSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
     if(squared) {
         QRect clip(0, 0, size, size);
         QRect scaledRect(QPoint(0,0), scaledSize);
         clip.moveCenter(scaledRect.center());
-        reader.setScaledClipRect(clip);
+        result = ImageLib::cropped(&scaled, clip);
+    } else {
+        result = new QImage(scaled);
     }
-    QSize originalSize = reader.size();
-    result = new QImage(reader.read());
+    return std::make_pair(result, originalSize);
+}
 
+// fallback for when the player plugin is not available
+QImage ThumbnailerRunnable::grabVideoFrameExternal(QUrl path) {
+    QString tmpFilePath = settings->tmpDir() + path.fileName() + ".png";
+    QString tmpFilePathEsc = tmpFilePath;
+    tmpFilePathEsc.replace("%", "%%");
+    QString command = "\"" + settings->mpvBinary() + "\" --start=30% --frames=1 --aid=no --sid=no --no-config --load-scripts=no --no-terminal --o=\"" + tmpFilePathEsc + "\" \"" + path.toString() + "\"";
+    QProcess process;
+    process.start(command);
+    process.waitForFinished(8000);
+    process.close();
+
+    QImageReader reader(tmpFilePath, "png");
+    QImage frame = reader.read();
     // force reader to close file so it can be deleted later
     reader.setFileName("");
 
     // remove temporary file
     QFile tmpFile(tmpFilePath);
     tmpFile.remove();
-
-    return std::make_pair(result, originalSize);
+    return frame;
 }
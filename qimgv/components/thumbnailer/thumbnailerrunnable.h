@@ -9,6 +9,7 @@
 #include "components/cache/thumbnailcache.h"
 #include "utils/imagefactory.h"
 #include "utils/imagelib.h"
+#include "components/thumbnailer/videoframegrabber.h"
 #include "settings.h"
 #include <memory>
 #include <QImageWriter>
@@ -24,6 +25,7 @@ private:
     static QString generateIdString(QString path, int size, bool crop);
     static std::pair<QImage*, QSize> createThumbnail(QUrl path, const char* format, int size, bool crop);
     static std::pair<QImage*, QSize> createVideoThumbnail(QUrl path, int size, bool crop);
+    static QImage grabVideoFrameExternal(QUrl path);
     QString path;
     int size;
     bool crop, force;
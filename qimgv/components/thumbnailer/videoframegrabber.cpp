@@ -0,0 +1,73 @@
+#include "videoframegrabber.h"
+
+QMutex VideoFrameGrabber::poolMutex;
+QWaitCondition VideoFrameGrabber::grabberReturned;
+std::vector<std::shared_ptr<FrameGrabber>> VideoFrameGrabber::idle;
+int VideoFrameGrabber::created = 0;
+
+VideoFrameGrabber::createFrameGrabberFn VideoFrameGrabber::resolve() {
+#ifndef USE_MPV
+    return nullptr;
+#else
+    static QMutex mutex;
+    static bool initialized = false;
+    static createFrameGrabberFn fn = nullptr;
+    QMutexLocker locker(&mutex);
+    if(!initialized) {
+        initialized = true;
+        // never unloaded; pooled grabbers live as long as the process
+        static QLibrary lib;
+        QString pluginPath = playerPluginPath();
+        if(!pluginPath.isEmpty()) {
+            lib.setFileName(pluginPath);
+            fn = reinterpret_cast<createFrameGrabberFn>(lib.resolve("CreateFrameGrabber"));
+        }
+    }
+    return fn;
+#endif
+}
+
+bool VideoFrameGrabber::isAvailable() {
+    return resolve() != nullptr;
+}
+
+QImage VideoFrameGrabber::grabFrame(QString path, int percent) {
+    auto grabber = checkOut();
+    if(!grabber)
+        return QImage();
+    QImage frame = grabber->grabFrame(path, percent);
+    checkIn(grabber);
+    return frame;
+}
+
+// waits for an idle grabber once the pool is full
+std::shared_ptr<FrameGrabber> VideoFrameGrabber::checkOut() {
+    createFrameGrabberFn fn = resolve();
+    if(!fn)
+        return nullptr;
+    int limit = taskScheduler->maxActiveCount(TASK_THUMBNAIL);
+    {
+        QMutexLocker locker(&poolMutex);
+        while(idle.empty() && created >= limit)
+            grabberReturned.wait(&poolMutex);
+        if(!idle.empty()) {
+            auto grabber = idle.back();
+            idle.pop_back();
+            return grabber;
+        }
+        created++;
+    }
+    std::shared_ptr<FrameGrabber> grabber(fn());
+    if(!grabber) {
+        QMutexLocker locker(&poolMutex);
+        created--;
+        grabberReturned.wakeOne();
+    }
+    return grabber;
+}
+
+void VideoFrameGrabber::checkIn(std::shared_ptr<FrameGrabber> grabber) {
+    QMutexLocker locker(&poolMutex);
+    idle.push_back(grabber);
+    grabberReturned.wakeOne();
+}
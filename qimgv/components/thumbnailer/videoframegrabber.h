@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QImage>
+#include <QLibrary>
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+#include <vector>
+#include "components/thumbnailer/framegrabber.h"
+#include "components/scheduler/taskscheduler.h"
+#include "utils/stuff.h"
+
+// Grabs video frames in-process via the player plugin.
+// Grabbers are kept in a pool and reused for every file, so a folder of
+// videos costs one decoder setup per concurrent thumbnail task. The pool
+// holds no more grabbers than TASK_THUMBNAIL may run at once.
+class VideoFrameGrabber {
+public:
+    // false if the plugin is missing or too old
+    static bool isAvailable();
+    static QImage grabFrame(QString path, int percent);
+
+private:
+    typedef FrameGrabber* (*createFrameGrabberFn)();
+    static createFrameGrabberFn resolve();
+    static std::shared_ptr<FrameGrabber> checkOut();
+    static void checkIn(std::shared_ptr<FrameGrabber> grabber);
+
+    static QMutex poolMutex;
+    static QWaitCondition grabberReturned;
+    static std::vector<std::shared_ptr<FrameGrabber>> idle;
+    static int created;
+};
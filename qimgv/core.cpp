@@ -98,10 +98,16 @@ void Core::connectComponents() {
     connect(model.get(), &DirectoryModel::fileRemoved,    this, &Core::onFileRemoved);
     connect(model.get(), &DirectoryModel::fileRenamed,    this, &Core::onFileRenamed);
     connect(model.get(), &DirectoryModel::fileModified,   this, &Core::onFileModified);
+    connect(model.get(), &DirectoryModel::filesAdded,     this, &Core::onFilesAdded);
+    connect(model.get(), &DirectoryModel::filesRemoved,   this, &Core::onFilesRemoved);
     connect(model.get(), &DirectoryModel::loaded,         this, &Core::onModelLoaded);
+    connect(model.get(), &DirectoryModel::listingFinished, this, &Core::onModelListingFinished);
     connect(model.get(), &DirectoryModel::itemReady,      this, &Core::onModelItemReady);
     connect(model.get(), &DirectoryModel::itemUpdated,    this, &Core::onModelItemUpdated);
     connect(model.get(), &DirectoryModel::sortingChanged, this, &Core::onModelSortingChanged);
+    connect(model.get(), &DirectoryModel::fileOpItemFinished, this, &Core::onFileOpItemFinished);
+    connect(model.get(), &DirectoryModel::fileOpProgress, this, &Core::onFileOpProgress);
+    connect(model.get(), &DirectoryModel::fileOpFinished, this, &Core::onFileOpFinished);
 
     connect(&slideshowTimer, &QTimer::timeout, this, &Core::nextImageSlideshow);
 }
@@ -254,6 +260,16 @@ void Core::onModelLoaded() {
         syncRandomizer();
 }
 
+// final sorted order is known now, restore selection
+void Core::onModelListingFinished() {
+    presenter.reloadModel();
+    if(settings->shuffleEnabled())
+        syncRandomizer();
+    int index = model->indexOf(state.currentFileName);
+    presenter.selectAndFocus(index == -1 ? 0 : index);
+    updateInfoString();
+}
+
 void Core::onDirectoryViewItemSelected(int index) {
     // we aren`t using async load so it won't flicker with empty view
     mw->enableDocumentView();
@@ -453,11 +469,17 @@ void Core::removeFile(QString fileName, bool trash) {
             reopen = true;
         }
     }
+    if(trash) {
+        // runs in background, see onFileOpItemFinished()
+        if(reopen)
+            state.fileOpClosedName = fileName;
+        model->trashFiles(QStringList(model->fullPath(fileName)));
+        return;
+    }
     FileOpResult result;
     model->removeFile(fileName, trash, result);
     if(result == FileOpResult::SUCCESS) {
-        QString msg = trash ? "Moved to trash: " : "File removed: ";
-        mw->showMessage(msg + fileName);
+        mw->showMessage("File removed: " + fileName);
     } else {
         if(reopen)
             guiSetImage(img);
@@ -491,6 +513,61 @@ void Core::onFileAdded(QString fileName) {
         loadIndex(0, false, settings->usePreloader());
 }
 
+void Core::onFilesAdded(QStringList fileNames) {
+    updateInfoString();
+    if(model->itemCount() == fileNames.count() && state.currentFileName == "")
+        loadIndex(0, false, settings->usePreloader());
+}
+
+// indexes are ascending, so i files were removed before the i-th one
+void Core::onFilesRemoved(QStringList fileNames, QList<int> indexes) {
+    int i = fileNames.indexOf(state.currentFileName);
+    if(model->isEmpty()) {
+        mw->closeImage();
+        state.hasActiveImage = false;
+        state.currentFileName = "";
+    } else if(i != -1) {
+        int index = indexes.at(i) - i;
+        if(!loadIndex(index, true, settings->usePreloader()))
+            loadIndex(--index, true, settings->usePreloader());
+    }
+    updateInfoString();
+}
+
+void Core::onFileOpItemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result) {
+    Q_UNUSED(destPath)
+    QString fileName = QDir(model->directoryPath()).relativeFilePath(srcPath);
+    if(!state.fileOpClosedName.isEmpty() && fileName == state.fileOpClosedName) {
+        state.fileOpClosedName = "";
+        if(result != FileOpResult::SUCCESS && state.currentFileName == fileName)
+            guiSetImage(model->getItem(fileName));
+    }
+    if(type == FILEOP_TRASH && result == FileOpResult::SUCCESS)
+        mw->showMessage("Moved to trash: " + fileName);
+}
+
+// only shown for jobs that take a while
+void Core::onFileOpProgress(FileOpType type, int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal) {
+    if(type == FILEOP_TRASH)
+        return;
+    QString msg = (type == FILEOP_COPY) ? "Copying: " : "Moving: ";
+    msg += QString::number(filesDone) + "/" + QString::number(filesTotal);
+    if(bytesTotal > 0)
+        msg += " (" + QString::number(bytesDone * 100 / bytesTotal) + "%)";
+    mw->showMessage(msg);
+}
+
+void Core::onFileOpFinished(FileOpType type, int count, int failed, FileOpResult lastError) {
+    if(failed) {
+        outputError(lastError);
+        return;
+    }
+    if(type == FILEOP_COPY)
+        mw->showMessageSuccess(count == 1 ? "File copied." : QString::number(count) + " files copied.");
+    else if(type == FILEOP_MOVE)
+        mw->showMessageSuccess(count == 1 ? "File moved." : QString::number(count) + " files moved.");
+}
+
 void Core::onFileModified(QString fileName) {
     Q_UNUSED(fileName)
 }
@@ -557,45 +634,32 @@ void Core::moveCurrentFile(QString destDirectory) {
     if(model->isEmpty())
         return;
     mw->closeImage();
-    FileOpResult result;
-    model->moveTo(destDirectory, model->fullPath(selectedFileName()), result);
-    if(result == FileOpResult::SUCCESS) {
-        mw->showMessageSuccess("File moved.");
-    } else {
-        guiSetImage(model->getItem(selectedFileName()));
-        outputError(result);
-    }
+    state.fileOpClosedName = selectedFileName();
+    model->moveFiles(QStringList(model->fullPath(selectedFileName())), destDirectory);
 }
 
 void Core::copyUrls(QList<QUrl> urls, QString destDirectory) {
     if(model->isEmpty())
         return;
-    FileOpResult result;
-    QList<QUrl>::iterator i;
-    for(i = urls.begin(); i != urls.end(); ++i) {
-        model->copyTo(destDirectory, model->fullPath((*i).fileName()), result);
-    }
+    QStringList paths;
+    for(auto &url : urls)
+        paths.append(url.toLocalFile());
+    model->copyFiles(paths, destDirectory);
 }
 
 void Core::moveUrls(QList<QUrl> urls, QString destDirectory) {
     if(model->isEmpty())
         return;
-    FileOpResult result;
-    QList<QUrl>::iterator i;
-    for(i = urls.begin(); i != urls.end(); ++i) {
-        model->moveTo(destDirectory, model->fullPath((*i).fileName()), result);
-    }
+    QStringList paths;
+    for(auto &url : urls)
+        paths.append(url.toLocalFile());
+    model->moveFiles(paths, destDirectory);
 }
 
 void Core::copyCurrentFile(QString destDirectory) {
     if(model->isEmpty())
         return;
-    FileOpResult result;
-    model->copyTo(destDirectory, model->fullPath(selectedFileName()), result);
-    if(result == FileOpResult::SUCCESS)
-        mw->showMessageSuccess("File copied.");
-    else
-        outputError(result);
+    model->copyFiles(QStringList(model->fullPath(selectedFileName())), destDirectory);
 }
 
 void Core::toggleCropPanel() {
@@ -835,7 +899,7 @@ void Core::loadPath(QString path) {
     // load file / folderview
     if(fileInfo.isFile()) {
         int index = model->indexOf(fileInfo.fileName());
-        // DirectoryManager only checks file extensions via regex (performance reasons)
+        // DirectoryManager only checks file extensions (performance reasons)
         // But in this case we force check mimetype
         if(index == -1) {
             QStringList types = settings->supportedMimeTypes();
@@ -1008,10 +1072,9 @@ void Core::guiSetImage(std::shared_ptr<Image> img) {
     }
     DocumentType type = img->type();
     if(type == STATIC) {
-        mw->setImage(img->getPixmap());
+        mw->setImage(img->getImage());
     } else if(type == ANIMATED) {
-        auto animated = dynamic_cast<ImageAnimated *>(img.get());
-        mw->setAnimation(animated->getMovie());
+        mw->setAnimation(std::dynamic_pointer_cast<ImageAnimated>(img));
     } else if(type == VIDEO) {
         auto video = dynamic_cast<Video *>(img.get());
         // workaround for mpv. If we play video while mainwindow is hidden we get black screen.
@@ -19,6 +19,8 @@
 struct State {
     bool hasActiveImage = false;
     QString currentFileName = "";
+    // closed while it is being moved, shown again if that fails
+    QString fileOpClosedName = "";
 };
 
 enum MimeDataTarget {
@@ -97,6 +99,11 @@ private slots:
     void onFileRenamed(QString from, int indexFrom, QString to, int indexTo);
     void onFileAdded(QString fileName);
     void onFileModified(QString fileName);
+    void onFilesAdded(QStringList fileNames);
+    void onFilesRemoved(QStringList fileNames, QList<int> indexes);
+    void onFileOpItemFinished(FileOpType type, QString srcPath, QString destPath, FileOpResult result);
+    void onFileOpProgress(FileOpType type, int filesDone, int filesTotal, qint64 bytesDone, qint64 bytesTotal);
+    void onFileOpFinished(FileOpType type, int count, int failed, FileOpResult lastError);
     void showResizeDialog();
     void resize(QSize size);
     void flipH();
@@ -128,6 +135,7 @@ private slots:
     void onDropIn(const QMimeData *mimeData, QObject* source);
     void toggleShuffle();
     void onModelLoaded();
+    void onModelListingFinished();
     void outputError(const FileOpResult &error) const;
     void showOpenDialog();
     void showInDirectory();
@@ -0,0 +1,79 @@
+#include "thumbnailatlas.h"
+
+ThumbnailAtlas::ThumbnailAtlas()
+    : mCellSize(0),
+      cellsPerRow(0),
+      mGeneration(1)
+{
+}
+
+void ThumbnailAtlas::setCellSize(int size) {
+    if(size == mCellSize)
+        return;
+    clear();
+    mCellSize = size;
+    cellsPerRow = (size > 0) ? PAGE_SIZE / size : 0;
+}
+
+int ThumbnailAtlas::cellSize() const {
+    return mCellSize;
+}
+
+bool ThumbnailAtlas::insert(const QPixmap &pixmap, Slot &slot) {
+    remove(slot);
+    if(!cellsPerRow || pixmap.isNull() || pixmap.width() > mCellSize || pixmap.height() > mCellSize)
+        return false;
+    int pageIndex = 0;
+    while(pageIndex < pages.count() && pages.at(pageIndex).freeCells.isEmpty())
+        pageIndex++;
+    if(pageIndex == pages.count()) {
+        Page newPage;
+        int rows = cellsPerRow;
+        newPage.pixmap = QPixmap(cellsPerRow * mCellSize, rows * mCellSize);
+        newPage.pixmap.fill(Qt::transparent);
+        // pop from the back, so cells fill up in order
+        for(int i = cellsPerRow * rows - 1; i >= 0; i--)
+            newPage.freeCells.append(i);
+        pages.append(newPage);
+    }
+    Page &page = pages[pageIndex];
+    slot.page = pageIndex;
+    slot.cell = page.freeCells.takeLast();
+    slot.generation = mGeneration;
+    slot.rect = QRect(cellRect(slot.cell).topLeft(), pixmap.size());
+
+    QPainter painter(&page.pixmap);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    // explicit source rect, otherwise the pixmap's dpr would scale it down
+    painter.drawPixmap(slot.rect, pixmap, pixmap.rect());
+    return true;
+}
+
+void ThumbnailAtlas::remove(Slot &slot) {
+    if(isValid(slot))
+        pages[slot.page].freeCells.append(slot.cell);
+    slot = Slot();
+}
+
+bool ThumbnailAtlas::isValid(const Slot &slot) const {
+    return slot.generation == mGeneration && slot.page >= 0 && slot.page < pages.count();
+}
+
+int ThumbnailAtlas::pageCount() const {
+    return pages.count();
+}
+
+const QPixmap &ThumbnailAtlas::page(int index) const {
+    return pages.at(index).pixmap;
+}
+
+void ThumbnailAtlas::clear() {
+    pages.clear();
+    mGeneration++;
+}
+
+QRect ThumbnailAtlas::cellRect(int cell) const {
+    return QRect((cell % cellsPerRow) * mCellSize,
+                 (cell / cellsPerRow) * mCellSize,
+                 mCellSize, mCellSize);
+}
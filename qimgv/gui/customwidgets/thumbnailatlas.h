@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QPixmap>
+#include <QPainter>
+#include <QVector>
+#include <QRect>
+
+/* Packs equally sized thumbnails into a few large pixmaps,
+ * so the view can paint visible cells with one call per page.
+ * Cells are reused after remove(); changing the cell size drops
+ * everything and invalidates the slots handed out before.
+ */
+
+class ThumbnailAtlas {
+public:
+    struct Slot {
+        int page = -1;
+        int cell = -1;
+        uint generation = 0;
+        // part of the page holding the pixmap, device pixels
+        QRect rect;
+    };
+
+    ThumbnailAtlas();
+    // device pixels
+    void setCellSize(int size);
+    int cellSize() const;
+    bool insert(const QPixmap &pixmap, Slot &slot);
+    void remove(Slot &slot);
+    bool isValid(const Slot &slot) const;
+    int pageCount() const;
+    const QPixmap &page(int index) const;
+    void clear();
+
+private:
+    struct Page {
+        QPixmap pixmap;
+        QVector<int> freeCells;
+    };
+    const int PAGE_SIZE = 2048;
+    QVector<Page> pages;
+    int mCellSize, cellsPerRow;
+    uint mGeneration;
+
+    QRect cellRect(int cell) const;
+};
@@ -10,7 +10,8 @@ ThumbnailView::ThumbnailView(ThumbnailViewOrientation orient, QWidget *parent)
       selectMode(SELECT_BY_PRESS),
       mDragTarget(-1),
       mSelectedIndex(-1),
-      scrollTimeLine(nullptr)
+      scrollTimeLine(nullptr),
+      mItemCount(0)
 {
     setAccessibleName("thumbnailView");
     this->setMouseTracking(true);
@@ -93,13 +94,13 @@ void ThumbnailView::selectIndex(int index) {
     if(!checkRange(index))
         return;
 
-    if(checkRange(mSelectedIndex))
-        thumbnails.at(mSelectedIndex)->setHighlighted(false);
+    if(auto thumb = widgetAt(mSelectedIndex))
+        thumb->setHighlighted(false);
 
     mSelectedIndex = index;
 
-    ThumbnailWidget *thumb = thumbnails.at(mSelectedIndex);
-    thumb->setHighlighted(true);
+    if(auto thumb = widgetAt(mSelectedIndex))
+        thumb->setHighlighted(true);
     updateScrollbarIndicator();
 }
 
@@ -108,7 +109,7 @@ int ThumbnailView::selectedIndex() {
 }
 
 int ThumbnailView::itemCount() {
-    return thumbnails.count();
+    return mItemCount;
 }
 
 void ThumbnailView::showEvent(QShowEvent *event) {
@@ -120,24 +121,94 @@ void ThumbnailView::showEvent(QShowEvent *event) {
     loadVisibleThumbnails();
 }
 
-void ThumbnailView::populate(int count) {
-    if(count >= 0) {
-        // reuse existing items
-        if(count == thumbnails.count()) {
-            QList<ThumbnailWidget*>::iterator i;
-            for (i = thumbnails.begin(); i != thumbnails.end(); ++i) {
-                (*i)->reset();
-            }
+// ------------------------------------------------------------------- widget pool
+
+ThumbnailWidget *ThumbnailView::widgetAt(int index) {
+    return visibleItems.value(index, nullptr);
+}
+
+int ThumbnailView::indexOf(ThumbnailWidget *widget) {
+    return visibleItems.key(widget, -1);
+}
+
+QSizeF ThumbnailView::itemSize() {
+    // keep at least one widget around to measure
+    if(widgetPool.isEmpty())
+        releaseWidget(acquireWidget());
+    return widgetPool.first()->boundingRect().size();
+}
+
+ThumbnailWidget *ThumbnailView::acquireWidget() {
+    if(!freeWidgets.isEmpty())
+        return freeWidgets.takeLast();
+    ThumbnailWidget *widget = createThumbnailWidget();
+    widget->setThumbnailSize(mThumbnailSize);
+    widget->setAtlas(atlas.get());
+    scene.addItem(widget);
+    widgetPool.append(widget);
+    return widget;
+}
+
+void ThumbnailView::releaseWidget(ThumbnailWidget *widget) {
+    widget->reset();
+    widget->hide();
+    freeWidgets.append(widget);
+}
+
+void ThumbnailView::releaseAllWidgets() {
+    for(auto widget : visibleItems)
+        releaseWidget(widget);
+    visibleItems.clear();
+}
+
+// moves bound widgets with index >= from by delta
+void ThumbnailView::shiftIndexes(int from, int delta) {
+    QHash<int, ThumbnailWidget*> shifted;
+    shifted.reserve(visibleItems.count());
+    for(auto i = visibleItems.constBegin(); i != visibleItems.constEnd(); ++i)
+        shifted.insert(i.key() >= from ? i.key() + delta : i.key(), i.value());
+    visibleItems.swap(shifted);
+}
+
+QRectF ThumbnailView::preloadRect() {
+    QRectF visibleRect = mapToScene(viewport()->geometry()).boundingRect();
+    // grow rectangle to cover nearby offscreen items
+    visibleRect.adjust(-offscreenPreloadArea, -offscreenPreloadArea,
+                       offscreenPreloadArea, offscreenPreloadArea);
+    return visibleRect;
+}
+
+// binds widgets to the items around viewport, recycling the ones that went offscreen
+void ThumbnailView::updateVisibleItems() {
+    if(!isVisible())
+        return;
+    QPair<int, int> range = indexRangeFor(preloadRect());
+    for(auto i = visibleItems.begin(); i != visibleItems.end();) {
+        if(i.key() < range.first || i.key() > range.second) {
+            releaseWidget(i.value());
+            i = visibleItems.erase(i);
         } else {
-            removeAll();
-            for(int i = 0; i < count; i++) {
-                ThumbnailWidget *widget = createThumbnailWidget();
-                widget->setThumbnailSize(mThumbnailSize);
-                thumbnails.append(widget);
-                addItemToLayout(widget, i);
-            }
+            ++i;
         }
     }
+    for(int i = range.first; i <= range.second; i++) {
+        if(visibleItems.contains(i))
+            continue;
+        ThumbnailWidget *widget = acquireWidget();
+        widget->setPos(itemRect(i).topLeft());
+        widget->setHighlighted(i == mSelectedIndex);
+        widget->show();
+        visibleItems.insert(i, widget);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailView::populate(int count) {
+    if(count >= 0) {
+        releaseAllWidgets();
+        mItemCount = count;
+    }
     mSelectedIndex = -1;
     mDragTarget = -1;
     updateLayout();
@@ -147,17 +218,49 @@ void ThumbnailView::populate(int count) {
 }
 
 void ThumbnailView::addItem() {
-    insertItem(thumbnails.count());
+    insertItem(mItemCount);
 }
 
 // insert at index
 void ThumbnailView::insertItem(int index) {
+    insertItems(index, 1);
+}
+
+// one layout update for the whole range
+void ThumbnailView::insertItems(int index, int count) {
+    if(index < 0 || index > mItemCount || count <= 0)
+        return;
     if(index <= mSelectedIndex) {
-        mSelectedIndex++;
+        mSelectedIndex += count;
     }
-    ThumbnailWidget *widget = createThumbnailWidget();
-    thumbnails.insert(index, widget);
-    addItemToLayout(widget, index);
+    mItemCount += count;
+    shiftIndexes(index, count);
+    updateLayout();
+    fitSceneToContents();
+    updateScrollbarIndicator();
+    loadVisibleThumbnails();
+}
+
+void ThumbnailView::insertItems(QList<int> indexes) {
+    if(indexes.isEmpty())
+        return;
+    // where an item with the old index ends up
+    auto shifted = [&indexes](int index) {
+        for(int inserted : indexes) {
+            if(inserted > index)
+                break;
+            index++;
+        }
+        return index;
+    };
+    QHash<int, ThumbnailWidget*> moved;
+    moved.reserve(visibleItems.count());
+    for(auto i = visibleItems.constBegin(); i != visibleItems.constEnd(); ++i)
+        moved.insert(shifted(i.key()), i.value());
+    visibleItems.swap(moved);
+    if(mSelectedIndex != -1)
+        mSelectedIndex = shifted(mSelectedIndex);
+    mItemCount += indexes.count();
     updateLayout();
     fitSceneToContents();
     updateScrollbarIndicator();
@@ -166,14 +269,17 @@ void ThumbnailView::insertItem(int index) {
 
 void ThumbnailView::removeItem(int index) {
     if(checkRange(index)) {
-        removeItemFromLayout(index);
-        delete thumbnails.takeAt(index);
+        if(auto widget = visibleItems.take(index))
+            releaseWidget(widget);
+        shiftIndexes(index + 1, -1);
+        mItemCount--;
+        updateLayout();
         fitSceneToContents();
         if(index < mSelectedIndex) {
             selectIndex(mSelectedIndex - 1);
         } else if(index == mSelectedIndex) {
-            if(mSelectedIndex >= thumbnails.count())
-                selectIndex(thumbnails.count() - 1);
+            if(mSelectedIndex >= mItemCount)
+                selectIndex(mItemCount - 1);
             else
                 selectIndex(mSelectedIndex);
         }
@@ -182,11 +288,38 @@ void ThumbnailView::removeItem(int index) {
     }
 }
 
-void ThumbnailView::reloadItem(int index) {
-    if(!checkRange(index))
+void ThumbnailView::removeItems(QList<int> indexes) {
+    if(indexes.isEmpty())
         return;
-    auto thumb = thumbnails.at(index);
-    if(thumb->isLoaded) {
+    auto removedBefore = [&indexes](int index) {
+        return static_cast<int>(std::lower_bound(indexes.begin(), indexes.end(), index) - indexes.begin());
+    };
+    if(auto thumb = widgetAt(mSelectedIndex))
+        thumb->setHighlighted(false);
+    QHash<int, ThumbnailWidget*> moved;
+    moved.reserve(visibleItems.count());
+    for(auto i = visibleItems.constBegin(); i != visibleItems.constEnd(); ++i) {
+        if(std::binary_search(indexes.begin(), indexes.end(), i.key()))
+            releaseWidget(i.value());
+        else
+            moved.insert(i.key() - removedBefore(i.key()), i.value());
+    }
+    visibleItems.swap(moved);
+    mItemCount -= indexes.count();
+    updateLayout();
+    fitSceneToContents();
+    // selection stays at the same position, or the last item
+    if(mSelectedIndex != -1)
+        mSelectedIndex = qMin(mSelectedIndex - removedBefore(mSelectedIndex), mItemCount - 1);
+    if(auto thumb = widgetAt(mSelectedIndex))
+        thumb->setHighlighted(true);
+    updateScrollbarIndicator();
+    loadVisibleThumbnails();
+}
+
+void ThumbnailView::reloadItem(int index) {
+    auto thumb = widgetAt(index);
+    if(thumb && thumb->isLoaded) {
         thumb->unsetThumbnail();
         emit thumbnailsRequested(QList<int>() << index, static_cast<int>(qApp->devicePixelRatio() * mThumbnailSize), mCropThumbnails, true);
     }
@@ -205,48 +338,42 @@ void ThumbnailView::setDrawScrollbarIndicator(bool mode) {
 }
 
 void ThumbnailView::setThumbnail(int pos, std::shared_ptr<Thumbnail> thumb) {
-    if(thumb && thumb->size() == floor(mThumbnailSize * qApp->devicePixelRatio()) && checkRange(pos)) {
-        thumbnails.at(pos)->setThumbnail(thumb);
+    // results for items which were scrolled away are dropped
+    auto widget = widgetAt(pos);
+    if(widget && thumb && thumb->size() == floor(mThumbnailSize * qApp->devicePixelRatio())) {
+        // drops cells of the previous size
+        if(atlas)
+            atlas->setCellSize(thumb->size());
+        widget->setThumbnail(thumb);
     }
 }
 
 void ThumbnailView::unloadAllThumbnails() {
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->unsetThumbnail();
-    }
+    for(auto widget : visibleItems)
+        widget->unsetThumbnail();
 }
 
 void ThumbnailView::loadVisibleThumbnails() {
     loadTimer.stop();
+    updateVisibleItems();
     if(isVisible() && !blockThumbnailLoading) {
-        QRectF visibleRect = mapToScene(viewport()->geometry()).boundingRect();
-        // grow rectangle to cover nearby offscreen items
-        visibleRect.adjust(-offscreenPreloadArea, -offscreenPreloadArea,
-                           offscreenPreloadArea, offscreenPreloadArea);
-        QList<QGraphicsItem *>visibleItems = scene.items(visibleRect,
-                                                         Qt::IntersectsItemShape,
-                                                         Qt::AscendingOrder);
         // load new previews
         QList<int> loadList;
-        for(int i = 0; i < visibleItems.count(); i++) {
-            ThumbnailWidget* widget = qgraphicsitem_cast<ThumbnailWidget*>(visibleItems.at(i));
-            if(widget && !widget->isLoaded)
-                loadList.append(thumbnails.indexOf(widget));
+        for(auto i = visibleItems.constBegin(); i != visibleItems.constEnd(); ++i) {
+            if(!i.value()->isLoaded)
+                loadList.append(i.key());
         }
         if(loadList.count()) {
+            std::sort(loadList.begin(), loadList.end());
             emit thumbnailsRequested(loadList, static_cast<int>(qApp->devicePixelRatio() * mThumbnailSize), mCropThumbnails, false);
         }
-        // unload offscreen
-        for(int i = 0; i < thumbnails.count(); i++) {
-            if(!visibleItems.contains(thumbnails.at(i))) {
-                thumbnails.at(i)->unsetThumbnail();
-            }
-        }
     }
 }
 
 void ThumbnailView::loadVisibleThumbnailsDelayed() {
     loadTimer.stop();
+    // widgets are cheap to rebind, only delay the thumbnail requests
+    updateVisibleItems();
     loadTimer.start();
 }
 
@@ -295,29 +422,62 @@ bool ThumbnailView::atSceneEnd() {
 }
 
 bool ThumbnailView::checkRange(int pos) {
-    return pos >= 0 && pos < thumbnails.count();
+    return pos >= 0 && pos < mItemCount;
 }
 
 void ThumbnailView::updateLayout() {
-
+    for(auto i = visibleItems.constBegin(); i != visibleItems.constEnd(); ++i)
+        i.value()->setPos(itemRect(i.key()).topLeft());
 }
 
 // fit scene to it's contents size
 void ThumbnailView::fitSceneToContents() {
     QPointF center;
     if(this->orientation == THUMBNAILVIEW_VERTICAL) {
-        int height = qMax((int)scene.itemsBoundingRect().height(), this->height());
+        int height = qMax((int)contentsSize().height(), this->height());
         scene.setSceneRect(QRectF(0,0, this->width(), height));
         center = mapToScene(viewport()->rect().center());
         centerOn(0, center.y() + 1);
     } else {
-        int width = qMax((int)scene.itemsBoundingRect().width(), this->width());
+        int width = qMax((int)contentsSize().width(), this->width());
         scene.setSceneRect(QRectF(0,0, width, this->height()));
         center = mapToScene(viewport()->rect().center());
         centerOn(center.x(), 0);
     }
 }
 
+//################### painting ######################
+// Thumbnails stored in the atlas are painted here with one call per page,
+// on top of the highlight & shadow which widgets still draw themselves.
+void ThumbnailView::drawForeground(QPainter *painter, const QRectF &rect) {
+    if(!atlas || !atlas->pageCount())
+        return;
+    QVector<QVector<QPainter::PixmapFragment>> batches(atlas->pageCount());
+    QList<ThumbnailWidget*> painted;
+    for(auto widget : visibleItems) {
+        if(!widget->inAtlas())
+            continue;
+        QRectF target = widget->thumbnailRect().translated(widget->pos());
+        if(!target.intersects(rect))
+            continue;
+        const ThumbnailAtlas::Slot &slot = widget->atlasSlot();
+        QRectF source(slot.rect);
+        batches[slot.page].append(QPainter::PixmapFragment::create(target.center(), source,
+                                                                   target.width() / source.width(),
+                                                                   target.height() / source.height()));
+        painted.append(widget);
+    }
+    for(int i = 0; i < batches.count(); i++) {
+        if(!batches.at(i).isEmpty())
+            painter->drawPixmapFragments(batches.at(i).constData(), batches.at(i).count(), atlas->page(i));
+    }
+    for(auto widget : painted) {
+        painter->translate(widget->pos());
+        widget->drawForeground(painter);
+        painter->translate(-widget->pos());
+    }
+}
+
 //################### scrolling ######################
 void ThumbnailView::wheelEvent(QWheelEvent *event) {
     event->accept();
@@ -403,7 +563,7 @@ void ThumbnailView::mousePressEvent(QMouseEvent *event) {
     mDragTarget = -1;
     ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
     if(item) {
-        int index = thumbnails.indexOf(item);
+        int index = indexOf(item);
         if(event->button() == Qt::LeftButton) {
             if(selectMode == SELECT_BY_PRESS) {
                 emit itemSelected(index);
@@ -441,7 +601,7 @@ void ThumbnailView::mouseDoubleClickEvent(QMouseEvent *event) {
         if(event->button() == Qt::LeftButton) {
             ThumbnailWidget *item = dynamic_cast<ThumbnailWidget*>(itemAt(event->pos()));
             if(item) {
-                emit itemSelected(thumbnails.indexOf(item));
+                emit itemSelected(indexOf(item));
                 return;
             }
         }
@@ -1,9 +1,10 @@
 #pragma once
 
-/* This class manages QGraphicsScene, ThumbnailWidget list,
+/* This class manages QGraphicsScene, ThumbnailWidget pool,
  * scrolling, requesting and setting thumbnails.
+ * Only the items near the viewport have a widget; widgets are recycled
+ * and rebound to other indexes while scrolling.
  * It doesn't do actual positioning of thumbnails within the scene.
- * (But maybe it should?)
  *
  * Usage: subclass, implement layout-related stuff
  */
@@ -18,6 +19,7 @@
 #include <QTimer>
 #include <QElapsedTimer>
 #include "gui/customwidgets/thumbnailwidget.h"
+#include "gui/customwidgets/thumbnailatlas.h"
 #include "gui/idirectoryview.h"
 
 enum ThumbnailViewOrientation {
@@ -52,7 +54,10 @@ public slots:
     virtual void populate(int count) Q_DECL_OVERRIDE;
     virtual void setThumbnail(int pos, std::shared_ptr<Thumbnail> thumb) Q_DECL_OVERRIDE;
     virtual void insertItem(int index) Q_DECL_OVERRIDE;
+    virtual void insertItems(int index, int count) Q_DECL_OVERRIDE;
+    virtual void insertItems(QList<int> indexes) Q_DECL_OVERRIDE;
     virtual void removeItem(int index) Q_DECL_OVERRIDE;
+    virtual void removeItems(QList<int> indexes) Q_DECL_OVERRIDE;
     virtual void reloadItem(int index) Q_DECL_OVERRIDE;
 
 signals:
@@ -78,9 +83,21 @@ private:
     ThumbnailWidget* dragTarget;
 
     void createScrollTimeLine();
+    ThumbnailWidget *acquireWidget();
+    void releaseWidget(ThumbnailWidget *widget);
+    void releaseAllWidgets();
+    void shiftIndexes(int from, int delta);
+    QRectF preloadRect();
 protected:
     QGraphicsScene scene;
-    QList<ThumbnailWidget*> thumbnails;
+    int mItemCount;
+    // widgets currently bound to an index
+    QHash<int, ThumbnailWidget*> visibleItems;
+    // every widget that was created, bound or not
+    QList<ThumbnailWidget*> widgetPool;
+    QList<ThumbnailWidget*> freeWidgets;
+    // batched painting; off unless a subclass creates it
+    std::unique_ptr<ThumbnailAtlas> atlas;
     QScrollBar *scrollBar;
     QTimeLine *scrollTimeLine;
     QPointF viewportCenter;
@@ -102,18 +119,29 @@ protected:
 
     bool checkRange(int pos);
 
+    // returns widget bound to index, or nullptr if it is offscreen
+    ThumbnailWidget *widgetAt(int index);
+    int indexOf(ThumbnailWidget *widget);
+    // size of a single cell; the same for every item
+    QSizeF itemSize();
+    void updateVisibleItems();
+
     virtual ThumbnailWidget *createThumbnailWidget() = 0;
-    virtual void addItemToLayout(ThumbnailWidget* widget, int pos) = 0;
-    virtual void removeItemFromLayout(int pos) = 0;
-    virtual void removeAll() = 0;
+    // repositions bound widgets
     virtual void updateLayout();
     virtual void fitSceneToContents();
     virtual void ensureSelectedItemVisible() = 0;
     virtual void updateScrollbarIndicator() = 0;
+    // first & last index of the items intersecting rect (in scene coords)
+    // computed from layout geometry; first > last if there are none
+    virtual QPair<int, int> indexRangeFor(QRectF rect) = 0;
+    virtual QRectF itemRect(int index) = 0;
+    virtual QSizeF contentsSize() = 0;
 
     void setCropThumbnails(bool);
     void setDrawScrollbarIndicator(bool mode);
 
+    void drawForeground(QPainter *painter, const QRectF &rect) Q_DECL_OVERRIDE;
     void wheelEvent(QWheelEvent *) Q_DECL_OVERRIDE;
     void mousePressEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
 
@@ -10,7 +10,8 @@ ThumbnailWidget::ThumbnailWidget(QGraphicsItem *parent) :
     mThumbnailSize(100),
     paddingX(1),
     paddingY(3),
-    textHeight(5)
+    textHeight(5),
+    atlas(nullptr)
 {
     setAttribute(Qt::WA_OpaquePaintEvent, true);
     setAcceptHoverEvents(true);
@@ -24,6 +25,10 @@ ThumbnailWidget::ThumbnailWidget(QGraphicsItem *parent) :
     fm = new QFontMetrics(font);
     fmSmall = new QFontMetrics(fontSmall);
     textHeight = fm->height();
+    nameText.setTextFormat(Qt::PlainText);
+    labelText.setTextFormat(Qt::PlainText);
+    nameText.setPerformanceHint(QStaticText::AggressiveCaching);
+    labelText.setPerformanceHint(QStaticText::AggressiveCaching);
 
     setThumbnailSize(100);
     readSettings();
@@ -58,6 +63,8 @@ int ThumbnailWidget::thumbnailSize() {
 void ThumbnailWidget::reset() {
     if(thumbnail)
         thumbnail.reset();
+    if(atlas)
+        atlas->remove(mAtlasSlot);
     highlighted = false;
     hovered = false;
     isLoaded = false;
@@ -95,6 +102,8 @@ void ThumbnailWidget::setThumbnail(std::shared_ptr<Thumbnail> _thumbnail) {
     if(_thumbnail) {
         thumbnail = _thumbnail;
         isLoaded = true;
+        if(atlas)
+            atlas->insert(*thumbnail->pixmap(), mAtlasSlot);
         updateThumbnailDrawPosition();
         setupLayout();
         updateHighlightRect();
@@ -105,6 +114,8 @@ void ThumbnailWidget::setThumbnail(std::shared_ptr<Thumbnail> _thumbnail) {
 void ThumbnailWidget::unsetThumbnail() {
     if(thumbnail)
         thumbnail.reset();
+    if(atlas)
+        atlas->remove(mAtlasSlot);
     isLoaded = false;
     /*
     updateThumbnailDrawPosition();
@@ -117,15 +128,31 @@ void ThumbnailWidget::unsetThumbnail() {
 void ThumbnailWidget::setupLayout() {
     nameRect = QRectF(highlightRect.left(), highlightRect.height(),
                       highlightRect.width(), textHeight * 1.7);
+    nameTextRect = nameRect.adjusted(4, 0, -4, 0);
 
     if(thumbnail && !thumbnail->label().isEmpty()) {
-        nameTextRect = nameRect.adjusted(4, 0, -4, 0);
         labelTextRect.setWidth(fmSmall->width(thumbnail->label()));
         labelTextRect.setHeight(nameRect.height());
         labelTextRect.moveTop(nameTextRect.top());
         labelTextRect.moveRight(nameTextRect.right());
         nameTextRect.adjust(0, 0, -labelTextRect.width() - 4, 0);
     }
+    if(thumbnail && mDrawLabel) {
+        cacheText(nameText, namePos, thumbnail->name(), font, fm, nameTextRect, false);
+        cacheText(labelText, labelPos, thumbnail->label(), fontSmall, fmSmall, labelTextRect, false);
+    }
+}
+
+// text layout is done here once instead of on every paint
+void ThumbnailWidget::cacheText(QStaticText &staticText, QPointF &pos, const QString &text, const QFont &textFont,
+                                const QFontMetrics *metrics, const QRectF &rect, bool center)
+{
+    staticText.setText(metrics->elidedText(text, Qt::ElideRight, static_cast<int>(rect.width())));
+    staticText.prepare(QTransform(), textFont);
+    qreal x = rect.left();
+    if(center)
+        x += (rect.width() - staticText.size().width()) / 2.0;
+    pos = QPointF(x, rect.top() + (rect.height() - metrics->height()) / 2.0);
 }
 
 void ThumbnailWidget::updateHighlightRect() {
@@ -195,18 +222,41 @@ void ThumbnailWidget::drawLabel(QPainter *painter) {
     painter->fillRect(nameRect, nameColor);
     painter->setOpacity(1.0);
     // filename
-    int flags = Qt::TextSingleLine | Qt::AlignVCenter;
     painter->setFont(font);
     painter->setPen(QColor(210, 210, 210, 255));
-    painter->drawText(nameTextRect, flags, thumbnail->name());
+    painter->drawStaticText(namePos, nameText);
     // additional info
     painter->setFont(fontSmall);
     painter->setPen(QColor(160, 160, 160, 255));
-    painter->drawText(labelTextRect, flags, thumbnail->label());
+    painter->drawStaticText(labelPos, labelText);
 }
 
 void ThumbnailWidget::drawThumbnail(QPainter* painter, qreal dpr, const QPixmap *pixmap) {
-    painter->drawPixmap(drawRectCentered, *pixmap);
+    if(!inAtlas())
+        painter->drawPixmap(drawRectCentered, *pixmap);
+}
+
+void ThumbnailWidget::setAtlas(ThumbnailAtlas *_atlas) {
+    if(atlas)
+        atlas->remove(mAtlasSlot);
+    atlas = _atlas;
+}
+
+// atlas copy is only used for the correctly sized thumbnail
+bool ThumbnailWidget::inAtlas() const {
+    return atlas && isLoaded && atlas->isValid(mAtlasSlot);
+}
+
+const ThumbnailAtlas::Slot &ThumbnailWidget::atlasSlot() const {
+    return mAtlasSlot;
+}
+
+QRectF ThumbnailWidget::thumbnailRect() const {
+    return drawRectCentered;
+}
+
+void ThumbnailWidget::drawForeground(QPainter *painter) {
+    Q_UNUSED(painter)
 }
 
 void ThumbnailWidget::drawIcon(QPainter* painter, qreal dpr, const QPixmap *pixmap) {
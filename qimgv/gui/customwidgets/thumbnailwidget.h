@@ -7,10 +7,12 @@
 #include <QPainter>
 #include <QGraphicsSceneHoverEvent>
 #include <QPaintEngine>
+#include <QStaticText>
 #include <cmath>
 #include "sourcecontainers/thumbnail.h"
 #include "settings.h"
 #include "sharedresources.h"
+#include "gui/customwidgets/thumbnailatlas.h"
 
 class ThumbnailWidget : public QGraphicsWidget {
     Q_OBJECT
@@ -44,6 +46,14 @@ public:
     void reset();
     void unsetThumbnail();
 
+    // when set, the pixmap is copied into the atlas and painted by the view
+    void setAtlas(ThumbnailAtlas *_atlas);
+    bool inAtlas() const;
+    const ThumbnailAtlas::Slot &atlasSlot() const;
+    QRectF thumbnailRect() const;
+    // painted by the view on top of atlas contents
+    virtual void drawForeground(QPainter *painter);
+
 protected slots:
     virtual void readSettings();
 
@@ -64,6 +74,8 @@ protected:
     virtual void updateHighlightRect();
 
     virtual void updateThumbnailDrawPosition();
+    void cacheText(QStaticText &staticText, QPointF &pos, const QString &text, const QFont &textFont,
+                   const QFontMetrics *metrics, const QRectF &rect, bool center);
 
     std::shared_ptr<Thumbnail> thumbnail;
     bool highlighted, hovered, mDrawLabel;
@@ -73,4 +85,9 @@ protected:
     QFont font, fontSmall;
     QFontMetrics *fm, *fmSmall;
     QRect drawRectCentered;
+    // pre-laid out label text
+    QStaticText nameText, labelText;
+    QPointF namePos, labelPos;
+    ThumbnailAtlas *atlas;
+    ThumbnailAtlas::Slot mAtlasSlot;
 };
@@ -60,42 +60,40 @@ FlowLayout::FlowLayout()
     m_spacing[1] = 0;
     m_rows = 0;
     m_columns = 0;
+    m_uniform = false;
+    m_count = 0;
+    m_width = 0;
+    m_centerOffset = 0;
     QSizePolicy sp = sizePolicy();
     sp.setHeightForWidth(true);
     setSizePolicy(sp);
 }
 
-int FlowLayout::itemAbove(int index) {
-    if(index >= m_items.count() || index < 0)
+int FlowLayout::itemAbove(int index, int rows) {
+    if(index >= gridCount() || index < 0 || m_columns <= 0)
         return -1;
 
-    int indexAbove = index - m_columns;
-    if(indexAbove >= 0)
-        return indexAbove;
-    else
-        return index;
+    int rowsAbove = qMin(index / m_columns, rows);
+    return index - rowsAbove * m_columns;
 }
 
-int FlowLayout::itemBelow(int index) {
-    if(index >= m_items.count() || index < 0)
+int FlowLayout::itemBelow(int index, int rows) {
+    if(index >= gridCount() || index < 0 || m_columns <= 0)
         return -1;
 
-    if(sameRow(index, m_items.count() - 1))
-        return index;
-
-    int indexBelow = index + m_columns;
-    if(indexBelow < m_items.count())
-        return indexBelow;
-    else
-        return m_items.count() - 1;
+    int lastRow = (gridCount() - 1) / m_columns;
+    int rowsBelow = qMin(lastRow - index / m_columns, rows);
+    return qMin(index + rowsBelow * m_columns, gridCount() - 1);
 }
 
 bool FlowLayout::sameRow(int one, int two) {
+    if(m_columns <= 0)
+        return true;
     return ((one / m_columns) == (two / m_columns));
 }
 
 int FlowLayout::columnOf(int index) {
-    if(index >= m_items.count() || index < 0)
+    if(index >= gridCount() || index < 0 || m_columns <= 0)
         return -1;
 
     int col = index % m_columns;
@@ -115,7 +113,13 @@ void FlowLayout::insertItem(int index, QGraphicsLayoutItem *item) {
     if(uint(index) > uint(m_items.count()))
         index = m_items.count();
     m_items.insert(index, item);
-    invalidate();
+    if(m_uniform) {
+        m_count = m_items.count();
+        // centering offset may change when the first row fills up
+        layoutItems(updateGrid() ? 0 : index);
+    } else {
+        invalidate();
+    }
 }
 
 int FlowLayout::count() const
@@ -131,13 +135,23 @@ QGraphicsLayoutItem *FlowLayout::itemAt(int index) const
 void FlowLayout::removeAt(int index)
 {
     m_items.removeAt(index);
-    invalidate();
+    if(m_uniform) {
+        m_count = m_items.count();
+        layoutItems(updateGrid() ? 0 : index);
+    } else {
+        invalidate();
+    }
 }
 
 void FlowLayout::clear()
 {
     m_items.clear();
-    invalidate();
+    if(m_uniform) {
+        m_count = 0;
+        updateGrid();
+    } else {
+        invalidate();
+    }
 }
 
 qreal FlowLayout::spacing(Qt::Orientation o) const
@@ -156,6 +170,12 @@ void FlowLayout::setSpacing(Qt::Orientations o, qreal spacing)
 void FlowLayout::setGeometry(const QRectF &geom)
 {
     QGraphicsLayout::setGeometry(geom);
+    if(m_uniform) {
+        m_width = geom.width();
+        if(updateGrid())
+            layoutItems(0);
+        return;
+    }
     GridInfo gInfo = doLayout(geom, true);
     m_columns = gInfo.columns;
     m_rows = gInfo.rows;
@@ -220,7 +240,16 @@ QSizeF FlowLayout::minSize(const QSizeF &constraint) const
     QSizeF size(0, 0);
     qreal left, top, right, bottom;
     getContentsMargins(&left, &top, &right, &bottom);
-    if (constraint.width() >= 0) {   // height for width
+    if (constraint.width() >= 0 && m_uniform) {
+        const qreal maxRowWidth = constraint.width() - left - right;
+        const qreal step = m_cellSize.width() + spacing(Qt::Horizontal);
+        int columns = qMax(static_cast<int>((maxRowWidth + spacing(Qt::Horizontal)) / step), 1);
+        int rows = (gridCount() + columns - 1) / columns;
+        qreal height = top + bottom;
+        if(rows)
+            height += rows * m_cellSize.height() + (rows - 1) * spacing(Qt::Vertical);
+        size = QSizeF(constraint.width(), height);
+    } else if (constraint.width() >= 0) {   // height for width
         const qreal height = doLayout(QRectF(QPointF(0,0), constraint), false).height;
         size = QSizeF(constraint.width(), height);
     } else if (constraint.height() >= 0) {  // width for height?
@@ -295,3 +324,104 @@ QSizeF FlowLayout::sizeHint(Qt::SizeHint which, const QSizeF &constraint) const
     }
     return sh;
 }
+
+// ------------------------------------------------------------ uniform grid mode
+
+void FlowLayout::setUniformItemSize(const QSizeF &size) {
+    bool uniform = !size.isEmpty();
+    if(uniform == m_uniform && size == m_cellSize)
+        return;
+    m_uniform = uniform;
+    m_cellSize = size;
+    if(m_uniform) {
+        if(!m_items.isEmpty())
+            m_count = m_items.count();
+        m_columns = 0; // force recalculation
+        updateGrid();
+        layoutItems(0);
+    } else {
+        invalidate();
+    }
+}
+
+// for layouts without items
+void FlowLayout::setItemCount(int count) {
+    if(!m_uniform || !m_items.isEmpty() || count == m_count)
+        return;
+    m_count = count;
+    updateGrid();
+}
+
+void FlowLayout::setWidth(qreal width) {
+    if(width == m_width)
+        return;
+    m_width = width;
+    if(m_uniform && updateGrid())
+        layoutItems(0);
+}
+
+int FlowLayout::gridCount() const {
+    return m_uniform ? m_count : m_items.count();
+}
+
+// recalculates columns & centering offset; O(1)
+// returns true when existing item positions are no longer valid
+bool FlowLayout::updateGrid() {
+    qreal left, top, right, bottom;
+    getContentsMargins(&left, &top, &right, &bottom);
+
+    const qreal maxRowWidth = m_width - left - right;
+    const qreal step = m_cellSize.width() + spacing(Qt::Horizontal);
+    int maxCols = static_cast<int>((maxRowWidth + spacing(Qt::Horizontal)) / step);
+    int columns = qMax(maxCols, 1);
+    qreal centerOffset = 0;
+    if(maxCols > 0 && m_count >= maxCols)
+        centerOffset = static_cast<int>(fmod(maxRowWidth + spacing(Qt::Horizontal), step) / 2);
+
+    bool changed = (columns != m_columns || centerOffset != m_centerOffset);
+    m_columns = columns;
+    m_centerOffset = centerOffset;
+    m_rows = (m_count + m_columns - 1) / m_columns;
+    return changed;
+}
+
+void FlowLayout::layoutItems(int from) {
+    for(int i = qMax(from, 0); i < m_items.count(); i++)
+        m_items.at(i)->setGeometry(itemRect(i));
+}
+
+QRectF FlowLayout::itemRect(int index) const {
+    if(m_columns <= 0)
+        return QRectF();
+    qreal left, top, right, bottom;
+    getContentsMargins(&left, &top, &right, &bottom);
+    int row = index / m_columns;
+    int col = index % m_columns;
+    return QRectF(left + m_centerOffset + col * (m_cellSize.width() + spacing(Qt::Horizontal)),
+                  top + row * (m_cellSize.height() + spacing(Qt::Vertical)),
+                  m_cellSize.width(), m_cellSize.height());
+}
+
+QPair<int, int> FlowLayout::indexRange(qreal top, qreal bottom) const {
+    if(!gridCount() || m_columns <= 0)
+        return qMakePair(0, -1);
+    qreal left, topMargin, right, bottomMargin;
+    getContentsMargins(&left, &topMargin, &right, &bottomMargin);
+    const qreal rowHeight = m_cellSize.height() + spacing(Qt::Vertical);
+    int firstRow = qMax(static_cast<int>(floor((top - topMargin) / rowHeight)), 0);
+    int lastRow = static_cast<int>(floor((bottom - topMargin) / rowHeight));
+    int first = firstRow * m_columns;
+    int last = qMin((lastRow + 1) * m_columns - 1, gridCount() - 1);
+    if(lastRow < firstRow || first > last)
+        return qMakePair(0, -1);
+    return qMakePair(first, last);
+}
+
+qreal FlowLayout::contentHeight() const {
+    qreal left, top, right, bottom;
+    getContentsMargins(&left, &top, &right, &bottom);
+    qreal height = top + bottom;
+    if(m_rows)
+        height += m_rows * m_cellSize.height() + (m_rows - 1) * spacing(Qt::Vertical);
+    return height;
+}
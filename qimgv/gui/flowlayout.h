@@ -51,6 +51,7 @@
 #pragma once
 
 #include <QGraphicsLayout>
+#include <QPair>
 #include <QDebug>
 #include <QElapsedTimer>
 
@@ -79,9 +80,9 @@ public:
     QGraphicsLayoutItem *itemAt(int index) const override;
     void removeAt(int index) override;
 
-    // returns the index of item above / below
-    int itemAbove(int index);
-    int itemBelow(int index);
+    // returns the index of item n rows above / below
+    int itemAbove(int index, int rows = 1);
+    int itemBelow(int index, int rows = 1);
     int rows();
     int columns();
     void clear();
@@ -89,6 +90,19 @@ public:
     int columnOf(int index);
     bool sameRow(int one, int two);
 
+    // Uniform grid mode. Every cell has the same size, so rows, columns
+    // and positions are derived from the index instead of a layout pass.
+    // Inserts & removes only move the items after the changed index.
+    // It also works without any layout items (setItemCount), for views
+    // which position their own widgets.
+    void setUniformItemSize(const QSizeF &size);
+    void setItemCount(int count);
+    void setWidth(qreal width);
+    QRectF itemRect(int index) const;
+    // first & last index of the rows between top and bottom; first > last if none
+    QPair<int, int> indexRange(qreal top, qreal bottom) const;
+    qreal contentHeight() const;
+
 protected:
     QSizeF sizeHint(Qt::SizeHint which, const QSizeF &constraint = QSizeF()) const override;
 
@@ -97,8 +111,15 @@ private:
     QSizeF minSize(const QSizeF &constraint) const;
     QSizeF prefSize() const;
     QSizeF maxSize() const;
+    int gridCount() const;
+    bool updateGrid();
+    void layoutItems(int from);
 
     QList<QGraphicsLayoutItem*> m_items;
     qreal m_spacing[2];
     int m_rows, m_columns;
+    bool m_uniform;
+    QSizeF m_cellSize;
+    int m_count;
+    qreal m_width, m_centerOffset;
 };
@@ -15,20 +15,26 @@ FolderGridView::FolderGridView(QWidget *parent)
     setDrawScrollbarIndicator(false);
     setSelectMode(SELECT_BY_DOUBLECLICK);
 
+    // paint thumbnails from shared atlas pages instead of per widget
+    atlas.reset(new ThumbnailAtlas());
+
     setupLayout();
     connect(this, &ThumbnailView::itemSelected,
             this, &FolderGridView::onitemSelected);
 }
 
+FolderGridView::~FolderGridView() {
+    delete flowLayout;
+}
+
 void FolderGridView::onitemSelected() {
     shiftedCol = -1;
 }
 
 void FolderGridView::updateScrollbarIndicator() {
-    if(!thumbnails.count() || selectedIndex() == -1)
+    if(!itemCount() || selectedIndex() == -1)
         return;
-    ThumbnailWidget *thumb = thumbnails.at(selectedIndex());
-    qreal itemCenter = (thumb->pos().y() + (thumb->height() / 2)) / scene.height();
+    qreal itemCenter = itemRect(selectedIndex()).center().y() / scene.height();
     indicator = QRect(2, scrollBar->height() * itemCenter - indicatorSize, scrollBar->width() - 4, indicatorSize);
 }
 
@@ -46,24 +52,23 @@ void FolderGridView::hide() {
 
 void FolderGridView::setShowLabels(bool mode) {
     mShowLabels = mode;
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->setDrawLabel(mShowLabels);
-    }
+    for(auto widget : widgetPool)
+        widget->setDrawLabel(mShowLabels);
     updateLayout();
     fitSceneToContents();
     ensureSelectedItemVisible();
+    loadVisibleThumbnails();
     emit showLabelsChanged(mShowLabels);
 }
 
 void FolderGridView::ensureSelectedItemVisible() {
     if(!checkRange(selectedIndex()))
         return;
-    ThumbnailWidget *thumb = thumbnails.at(selectedIndex());
-    ensureVisible(thumb, 0, 0);
+    ensureVisible(itemRect(selectedIndex()), 0, 0);
 }
 
 void FolderGridView::selectAbove() {
-    if(!thumbnails.count() || flowLayout->sameRow(0, selectedIndex()))
+    if(!itemCount() || flowLayout->sameRow(0, selectedIndex()))
         return;
     int newIndex;
     newIndex = flowLayout->itemAbove(selectedIndex());
@@ -79,12 +84,12 @@ void FolderGridView::selectAbove() {
 }
 
 void FolderGridView::selectBelow() {
-    if(!thumbnails.count() || flowLayout->sameRow(selectedIndex(), thumbnails.count() - 1))
+    if(!itemCount() || flowLayout->sameRow(selectedIndex(), itemCount() - 1))
         return;
     shiftedCol = -1;
     int newIndex = flowLayout->itemBelow(selectedIndex());
     if(!checkRange(newIndex))
-        newIndex = thumbnails.count() - 1;
+        newIndex = itemCount() - 1;
     if(flowLayout->columnOf(newIndex) != flowLayout->columnOf(selectedIndex()))
         shiftedCol = flowLayout->columnOf(selectedIndex());
     selectIndex(newIndex);
@@ -92,18 +97,18 @@ void FolderGridView::selectBelow() {
 }
 
 void FolderGridView::selectNext() {
-    if(!thumbnails.count() || selectedIndex() == thumbnails.count() - 1)
+    if(!itemCount() || selectedIndex() == itemCount() - 1)
         return;
     shiftedCol = -1;
     int newIndex = selectedIndex() + 1;
     if(!checkRange(newIndex))
-        newIndex = thumbnails.count() - 1;
+        newIndex = itemCount() - 1;
     selectIndex(newIndex);
     scrollToCurrent();
 }
 
 void FolderGridView::selectPrev() {
-    if(!thumbnails.count() || selectedIndex() == 0)
+    if(!itemCount() || selectedIndex() == 0)
         return;
     shiftedCol = -1;
     int newIndex = selectedIndex() - 1;
@@ -114,16 +119,10 @@ void FolderGridView::selectPrev() {
 }
 
 void FolderGridView::pageUp() {
-    if(!thumbnails.count() || flowLayout->sameRow(0, selectedIndex()))
+    if(!itemCount() || flowLayout->sameRow(0, selectedIndex()))
         return;
-    int newIndex = selectedIndex();
-    int tmp;
     // 4 rows up
-    for(int i = 0; i < 4; i++) {
-        tmp = flowLayout->itemAbove(newIndex);
-        if(checkRange(tmp))
-            newIndex = tmp;
-    }
+    int newIndex = flowLayout->itemAbove(selectedIndex(), 4);
     if(shiftedCol >= 0) {
         int diff = shiftedCol - flowLayout->columnOf(newIndex);
         newIndex += diff;
@@ -134,17 +133,11 @@ void FolderGridView::pageUp() {
 }
 
 void FolderGridView::pageDown() {
-    if(!thumbnails.count() || flowLayout->sameRow(selectedIndex(), thumbnails.count() - 1))
+    if(!itemCount() || flowLayout->sameRow(selectedIndex(), itemCount() - 1))
         return;
     shiftedCol = -1;
-    int newIndex = selectedIndex();
-    int tmp;
     // 4 rows down
-    for(int i = 0; i < 4; i++) {
-        tmp = flowLayout->itemBelow(newIndex);
-        if(checkRange(tmp))
-            newIndex = tmp;
-    }
+    int newIndex = flowLayout->itemBelow(selectedIndex(), 4);
     if(flowLayout->columnOf(newIndex) != flowLayout->columnOf(selectedIndex()))
         shiftedCol = flowLayout->columnOf(selectedIndex());
     selectIndex(newIndex);
@@ -152,7 +145,7 @@ void FolderGridView::pageDown() {
 }
 
 void FolderGridView::selectFirst() {
-    if(!thumbnails.count())
+    if(!itemCount())
         return;
     shiftedCol = -1;
     selectIndex(0);
@@ -160,10 +153,10 @@ void FolderGridView::selectFirst() {
 }
 
 void FolderGridView::selectLast() {
-    if(!thumbnails.count())
+    if(!itemCount())
         return;
     shiftedCol = -1;
-    selectIndex(thumbnails.count() - 1);
+    selectIndex(itemCount() - 1);
     scrollToCurrent();
 }
 
@@ -175,10 +168,8 @@ void FolderGridView::scrollToItem(int index) {
     if(!checkRange(index))
         return;
 
-    ThumbnailWidget *item = thumbnails.at(index);
-
     QRectF sceneRect = mapToScene(viewport()->rect()).boundingRect();
-    QRectF itemRect = item->mapRectToScene(item->rect());
+    QRectF itemRect = this->itemRect(index);
 
     bool visible = sceneRect.contains(itemRect);
     if(!visible) {
@@ -197,8 +188,7 @@ void FolderGridView::scrollToItem(int index) {
 void FolderGridView::focusOn(int index) {
     if(!checkRange(index))
         return;
-    ThumbnailWidget *thumb = thumbnails.at(index);
-    ensureVisible(thumb, 0, 0);
+    ensureVisible(itemRect(index), 0, 0);
     loadVisibleThumbnailsDelayed();
 }
 
@@ -208,9 +198,6 @@ void FolderGridView::setupLayout() {
     flowLayout = new FlowLayout();
     flowLayout->setContentsMargins(12,0,12,0);
     setFrameShape(QFrame::NoFrame);
-    scene.addItem(&holderWidget);
-    holderWidget.setLayout(flowLayout);
-    holderWidget.setContentsMargins(0,0,0,0);
 }
 
 ThumbnailWidget* FolderGridView::createThumbnailWidget() {
@@ -221,25 +208,32 @@ ThumbnailWidget* FolderGridView::createThumbnailWidget() {
     return widget;
 }
 
-void FolderGridView::addItemToLayout(ThumbnailWidget* widget, int pos) {
-    scene.addItem(widget);
-    flowLayout->insertItem(pos, widget);
+void FolderGridView::updateLayout() {
+    shiftedCol = -1;
+    updateGrid();
+    ThumbnailView::updateLayout();
 }
 
-void FolderGridView::removeItemFromLayout(int pos) {
-    flowLayout->removeAt(pos);
+// all of these are constant time
+void FolderGridView::updateGrid() {
+    flowLayout->setUniformItemSize(itemSize());
+    flowLayout->setItemCount(itemCount());
+    if(scrollBar->isVisible())
+        flowLayout->setWidth(width() - scrollBar->width());
+    else
+        flowLayout->setWidth(width());
 }
 
-void FolderGridView::removeAll() {
-    flowLayout->clear();
-    qDeleteAll(thumbnails);
-    thumbnails.clear();
+QRectF FolderGridView::itemRect(int index) {
+    return flowLayout->itemRect(index);
 }
 
-void FolderGridView::updateLayout() {
-    shiftedCol = -1;
-    flowLayout->invalidate();
-    flowLayout->activate();
+QSizeF FolderGridView::contentsSize() {
+    return QSizeF(width(), flowLayout->contentHeight());
+}
+
+QPair<int, int> FolderGridView::indexRangeFor(QRectF rect) {
+    return flowLayout->indexRange(rect.top(), rect.bottom());
 }
 
 void FolderGridView::keyPressEvent(QKeyEvent *event) {
@@ -288,22 +282,19 @@ void FolderGridView::zoomOut() {
 void FolderGridView::setThumbnailSize(int newSize) {
     newSize = clamp(newSize, THUMBNAIL_SIZE_MIN, THUMBNAIL_SIZE_MAX);
     mThumbnailSize = newSize;
-    for(int i = 0; i < thumbnails.count(); i++) {
-        thumbnails.at(i)->setThumbnailSize(newSize);
-    }
+    for(auto widget : widgetPool)
+        widget->setThumbnailSize(newSize);
     updateLayout();
     fitSceneToContents();
     if(checkRange(selectedIndex()))
-        ensureVisible(thumbnails.at(selectedIndex()), 0, 40);
+        ensureVisible(itemRect(selectedIndex()), 0, 40);
     emit thumbnailSizeChanged(mThumbnailSize);
     loadVisibleThumbnails();
 }
 
 void FolderGridView::fitSceneToContents() {
-    if(scrollBar->isVisible())
-        holderWidget.setGeometry(0,0, width() - scrollBar->width(), height());
-    else
-        holderWidget.setGeometry(0,0, width(), height());
+    updateGrid();
+    ThumbnailView::updateLayout();
     ThumbnailView::fitSceneToContents();
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QGraphicsWidget>
+#include <cmath>
 
 #include "gui/customwidgets/thumbnailview.h"
 #include "gui/folderview/thumbnailgridwidget.h"
@@ -13,6 +14,7 @@ class FolderGridView : public ThumbnailView
     Q_OBJECT
 public:
     explicit FolderGridView(QWidget *parent = nullptr);
+    ~FolderGridView();
 
     const int THUMBNAIL_SIZE_MIN = 100;  // px
     const int THUMBNAIL_SIZE_MAX = 400;  // these should be divisible by ZOOM_STEP
@@ -33,11 +35,13 @@ public slots:
     void setShowLabels(bool mode);
 
 private:
+    // used in uniform grid mode only for geometry; widgets are positioned by the view
     FlowLayout *flowLayout;
-    QGraphicsWidget holderWidget;
     int shiftedCol;
     bool mShowLabels;
 
+    void updateGrid();
+
     void scrollToCurrent();
     void scrollToItem(int index);
 private slots:
@@ -49,14 +53,14 @@ private slots:
 protected:
     void resizeEvent(QResizeEvent *event);
     virtual void updateScrollbarIndicator();
-    void addItemToLayout(ThumbnailWidget *widget, int pos);
-    void removeItemFromLayout(int pos);
-    void removeAll();
     void setupLayout();
     ThumbnailWidget *createThumbnailWidget();
     void updateLayout();
     void ensureSelectedItemVisible();
     virtual void fitSceneToContents() override;
+    QPair<int, int> indexRangeFor(QRectF rect);
+    QRectF itemRect(int index);
+    QSizeF contentsSize();
 
     void keyPressEvent(QKeyEvent *event);
     void wheelEvent(QWheelEvent *event);
@@ -300,10 +300,22 @@ void FolderView::insertItem(int index) {
     ui->thumbnailGrid->insertItem(index);
 }
 
+void FolderView::insertItems(int index, int count) {
+    ui->thumbnailGrid->insertItems(index, count);
+}
+
+void FolderView::insertItems(QList<int> indexes) {
+    ui->thumbnailGrid->insertItems(indexes);
+}
+
 void FolderView::removeItem(int index) {
     ui->thumbnailGrid->removeItem(index);
 }
 
+void FolderView::removeItems(QList<int> indexes) {
+    ui->thumbnailGrid->removeItems(indexes);
+}
+
 void FolderView::reloadItem(int index) {
     ui->thumbnailGrid->reloadItem(index);
 }
@@ -31,7 +31,10 @@ public slots:
     virtual void focusOn(int) Q_DECL_OVERRIDE;
     virtual void setDirectoryPath(QString path) Q_DECL_OVERRIDE;
     virtual void insertItem(int index) Q_DECL_OVERRIDE;
+    virtual void insertItems(int index, int count) Q_DECL_OVERRIDE;
+    virtual void insertItems(QList<int> indexes) Q_DECL_OVERRIDE;
     virtual void removeItem(int index) Q_DECL_OVERRIDE;
+    virtual void removeItems(QList<int> indexes) Q_DECL_OVERRIDE;
     virtual void reloadItem(int index) Q_DECL_OVERRIDE;
     void addItem();
     void onFullscreenModeChanged(bool mode);
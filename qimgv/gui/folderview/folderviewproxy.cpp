@@ -92,6 +92,26 @@ void FolderViewProxy::insertItem(int index) {
     }
 }
 
+void FolderViewProxy::insertItems(int index, int count) {
+    if(folderView) {
+        folderView->insertItems(index, count);
+    } else {
+        stateBuf.itemCount += count;
+    }
+}
+
+void FolderViewProxy::insertItems(QList<int> indexes) {
+    if(folderView) {
+        folderView->insertItems(indexes);
+    } else {
+        for(int index : indexes) {
+            if(index <= stateBuf.selectedIndex)
+                stateBuf.selectedIndex++;
+        }
+        stateBuf.itemCount += indexes.count();
+    }
+}
+
 void FolderViewProxy::removeItem(int index) {
     if(folderView) {
         folderView->removeItem(index);
@@ -108,6 +128,21 @@ void FolderViewProxy::removeItem(int index) {
     }
 }
 
+void FolderViewProxy::removeItems(QList<int> indexes) {
+    if(folderView) {
+        folderView->removeItems(indexes);
+    } else {
+        int removedBefore = 0;
+        for(int index : indexes) {
+            if(index < stateBuf.selectedIndex)
+                removedBefore++;
+        }
+        stateBuf.itemCount -= indexes.count();
+        if(stateBuf.selectedIndex != -1)
+            stateBuf.selectedIndex = qMin(stateBuf.selectedIndex - removedBefore, stateBuf.itemCount - 1);
+    }
+}
+
 void FolderViewProxy::reloadItem(int index) {
     if(folderView)
         folderView->reloadItem(index);
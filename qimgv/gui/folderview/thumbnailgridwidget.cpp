@@ -25,6 +25,8 @@ void ThumbnailGridWidget::setupLayout() {
                           mThumbnailSize, fm->height());
         nameTextRect = nameRect.adjusted(4, 0, -4, 0);
         nameFits = !(thumbnail && fm->width(thumbnail->name()) >= nameTextRect.width());
+        if(thumbnail)
+            cacheText(nameText, namePos, thumbnail->name(), font, fm, nameTextRect, nameFits);
     }
 }
 
@@ -40,7 +42,13 @@ void ThumbnailGridWidget::drawThumbnail(QPainter *painter, qreal dpr, const QPix
     // draw a shadow rectangle
     if(!thumbnail->hasAlphaChannel())
         painter->fillRect(drawRectCentered.adjusted(3,3,3,3), shadowColor);
-    painter->drawPixmap(drawRectCentered, *pixmap);
+    if(!inAtlas()) {
+        painter->drawPixmap(drawRectCentered, *pixmap);
+        drawForeground(painter);
+    }
+}
+
+void ThumbnailGridWidget::drawForeground(QPainter *painter) {
     if(isHovered()) {
         painter->fillRect(drawRectCentered, QColor(255,255,255, 18));
     }
@@ -55,11 +63,6 @@ void ThumbnailGridWidget::drawHover(QPainter *painter) {
 
 void ThumbnailGridWidget::drawLabel(QPainter *painter) {
     // filename
-    int flags;
-    if(nameFits)
-        flags = Qt::TextSingleLine | Qt::AlignVCenter | Qt::AlignHCenter;
-    else
-        flags = Qt::TextSingleLine | Qt::AlignVCenter;
     painter->setFont(font);
     //shadow
     //painter->setPen(shadowColor);
@@ -69,7 +72,7 @@ void ThumbnailGridWidget::drawLabel(QPainter *painter) {
     //    painter->setPen(QColor(240, 240, 240, 255));
     //else
         painter->setPen(QColor(220, 220, 220, 255));
-    painter->drawText(nameTextRect, flags, thumbnail->name());
+    painter->drawStaticText(namePos, nameText);
     // additional info
     //painter->setFont(fontSmall);
     //painter->setPen(QColor(160, 160, 160, 255));
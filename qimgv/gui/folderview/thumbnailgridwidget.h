@@ -6,6 +6,7 @@ class ThumbnailGridWidget : public ThumbnailWidget {
 public:
     ThumbnailGridWidget(QGraphicsItem *parent = nullptr);
     QRectF boundingRect() const Q_DECL_OVERRIDE;
+    virtual void drawForeground(QPainter *painter) Q_DECL_OVERRIDE;
 
 protected:
     virtual void setupLayout() Q_DECL_OVERRIDE;
@@ -15,7 +15,12 @@ public:
     virtual int selectedIndex() = 0;
     virtual void setDirectoryPath(QString path) = 0;
     virtual void insertItem(int index) = 0;
+    virtual void insertItems(int index, int count) = 0;
+    // positions in the resulting list, ascending
+    virtual void insertItems(QList<int> indexes) = 0;
     virtual void removeItem(int index) = 0;
+    // positions in the current list, ascending
+    virtual void removeItems(QList<int> indexes) = 0;
     virtual void reloadItem(int index) = 0;
 
 //signals
@@ -209,13 +209,13 @@ void MW::closeImage() {
     viewerWidget->closeImage();
 }
 
-void MW::setImage(std::unique_ptr<QPixmap> pixmap) {
-    viewerWidget->showImage(std::move(pixmap));
+void MW::setImage(std::shared_ptr<const QImage> image) {
+    viewerWidget->showImage(image);
     updateCropPanelData();
 }
 
-void MW::setAnimation(std::unique_ptr<QMovie> movie) {
-    viewerWidget->showAnimation(std::move(movie));
+void MW::setAnimation(std::shared_ptr<ImageAnimated> animation) {
+    viewerWidget->showAnimation(animation);
     updateCropPanelData();
 }
 
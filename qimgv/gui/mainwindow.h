@@ -55,8 +55,8 @@ public:
     explicit MW(QWidget *parent = nullptr);
     bool isCropPanelActive();
     void onScalingFinished(std::unique_ptr<QPixmap>scaled);
-    void setImage(std::unique_ptr<QPixmap> pixmap);
-    void setAnimation(std::unique_ptr<QMovie> movie);
+    void setImage(std::shared_ptr<const QImage> image);
+    void setAnimation(std::shared_ptr<ImageAnimated> animation);
     void setVideo(QString file);
 
     void setCurrentInfo(int fileIndex, int fileCount, QString fileName, QSize imageSize, qint64 fileSize, bool slideshow);
@@ -40,51 +40,31 @@ void ThumbnailStrip::ensureSelectedItemVisible() {
 
 }
 
-void ThumbnailStrip::addItemToLayout(ThumbnailWidget* widget, int pos) {
-    scene.addItem(widget);
-    updateThumbnailPositions(pos, thumbnails.count() - 1);
+// single row, no layout object needed
+QRectF ThumbnailStrip::itemRect(int index) {
+    QSizeF cell = itemSize();
+    return QRectF(index * (cell.width() + thumbnailSpacing), 0, cell.width(), cell.height());
 }
 
-void ThumbnailStrip::removeItemFromLayout(int pos) {
-    if(checkRange(pos)) {
-        ThumbnailWidget *thumb = thumbnails.at(pos);
-        scene.removeItem(thumb);
-        // move items left
-        ThumbnailWidget *tmp;
-        for(int i = pos; i < thumbnails.count(); i++) {
-            tmp = thumbnails.at(i);
-            tmp->moveBy(-tmp->boundingRect().width(), 0);
-        }
-    }
-}
-
-void ThumbnailStrip::removeAll() {
-    scene.clear(); // also calls delete on all items
-    thumbnails.clear();
+QSizeF ThumbnailStrip::contentsSize() {
+    QSizeF cell = itemSize();
+    return QSizeF(itemCount() * (cell.width() + thumbnailSpacing), cell.height());
 }
 
-void ThumbnailStrip::updateThumbnailPositions() {
-    updateThumbnailPositions(0, thumbnails.count() - 1);
-}
-
-void ThumbnailStrip::updateThumbnailPositions(int start, int end) {
-    if(start > end || !checkRange(start) || !checkRange(end)) {
-        return;
-    }
-    // assume all thumbnails are the same size
-    int thumbWidth = static_cast<int>(thumbnails.at(start)->boundingRect().width()) + thumbnailSpacing;
-    ThumbnailWidget *tmp;
-    for(int i = start; i <= end; i++) {
-        tmp = thumbnails.at(i);
-        tmp->setPos(i * thumbWidth, 0);
-    }
+// thumbnails are laid out in a single row, so this is just a division
+QPair<int, int> ThumbnailStrip::indexRangeFor(QRectF rect) {
+    if(!itemCount())
+        return qMakePair(0, -1);
+    qreal thumbWidth = itemSize().width() + thumbnailSpacing;
+    int first = qMax(static_cast<int>(floor(rect.left() / thumbWidth)), 0);
+    int last = qMin(static_cast<int>(floor(rect.right() / thumbWidth)), itemCount() - 1);
+    return qMakePair(first, last);
 }
 
 void ThumbnailStrip::focusOn(int index) {
     if(!checkRange(index))
         return;
-    ThumbnailWidget *thumb = thumbnails.at(index);
-    ensureVisible(thumb, 0, 0);
+    ensureVisible(itemRect(index), 0, 0);
     loadVisibleThumbnails();
 }
 
@@ -94,21 +74,20 @@ void ThumbnailStrip::readSettings() {
 
 void ThumbnailStrip::ensureThumbnailVisible(int pos) {
     if(checkRange(pos))
-        ensureVisible(thumbnails.at(pos)->sceneBoundingRect(),
-                      mThumbnailSize / 2, 0);
+        ensureVisible(itemRect(pos), mThumbnailSize / 2, 0);
 }
 
 // scene stuff??
 void ThumbnailStrip::setThumbnailSize(int newSize) {
     if(newSize >= 20) {
         mThumbnailSize = newSize;
-        for(int i=0; i<thumbnails.count(); i++) {
-            thumbnails.at(i)->setThumbnailSize(newSize);
-        }
+        for(auto widget : widgetPool)
+            widget->setThumbnailSize(newSize);
         //scene.invalidate(scene.sceneRect());
-        updateThumbnailPositions(0, thumbnails.count() - 1);
+        updateLayout();
         fitSceneToContents();
         ensureThumbnailVisible(selectedIndex());
+        loadVisibleThumbnailsDelayed();
     }
 }
 
@@ -25,8 +25,6 @@ private:
 
     int thumbnailSpacing;
 
-    void updateThumbnailPositions(int start, int end);
-    void updateThumbnailPositions();
     void setThumbnailSize(int);
     void updateThumbnailSize();
     void setupLayout();
@@ -39,9 +37,9 @@ protected:
     virtual void resizeEvent(QResizeEvent *event);
     virtual void updateScrollbarIndicator();
     void ensureThumbnailVisible(int pos);
-    void addItemToLayout(ThumbnailWidget *widget, int pos);
-    void removeItemFromLayout(int pos);
-    void removeAll();
     ThumbnailWidget *createThumbnailWidget();
     void ensureSelectedItemVisible();
+    QPair<int, int> indexRangeFor(QRectF rect);
+    QRectF itemRect(int index);
+    QSizeF contentsSize();
 };
@@ -0,0 +1,187 @@
+#include "animationdecoder.h"
+
+// count and size come from the already loaded image; probing the file again
+// here would mean scanning all of a gif on the gui thread
+AnimationDecoder::AnimationDecoder(QString _fileName, QByteArray _format, int _frameCount, QSize _frameSize, QObject *parent)
+    : QThread(parent),
+      fileName(_fileName),
+      format(_format),
+      mFrameCount(_frameCount),
+      mFrameSize(_frameSize),
+      capacity(2),
+      transformMode(Qt::SmoothTransformation),
+      seekTarget(-1),
+      generation(0),
+      stopRequested(false)
+{
+    qint64 frameBytes = static_cast<qint64>(mFrameSize.width()) * mFrameSize.height() * 4;
+    if(frameBytes > 0)
+        capacity = static_cast<int>(qBound(qint64(2), MAX_MEMORY / frameBytes, qint64(MAX_FRAMES)));
+}
+
+AnimationDecoder::~AnimationDecoder() {
+    mutex.lock();
+    stopRequested = true;
+    notFull.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+bool AnimationDecoder::isValid() const {
+    return mFrameSize.isValid();
+}
+
+int AnimationDecoder::frameCount() const {
+    return mFrameCount;
+}
+
+QSize AnimationDecoder::frameSize() const {
+    return mFrameSize;
+}
+
+void AnimationDecoder::setTargetSize(QSize size, Qt::TransformationMode mode) {
+    QMutexLocker locker(&mutex);
+    targetSize = (size == mFrameSize) ? QSize() : size;
+    transformMode = mode;
+}
+
+bool AnimationDecoder::takeFrame(AnimationFrame &frame) {
+    QMutexLocker locker(&mutex);
+    if(ring.empty())
+        return false;
+    frame = std::move(ring.front());
+    ring.pop_front();
+    notFull.wakeAll();
+    frame.delay = playbackDelay(frame.delay);
+    return true;
+}
+
+int AnimationDecoder::playbackDelay(int delay) {
+    return (delay < 20) ? 100 : delay;
+}
+
+bool AnimationDecoder::hasFrames() const {
+    QMutexLocker locker(&mutex);
+    return !ring.empty();
+}
+
+// stepping forward usually finds the frame already decoded
+void AnimationDecoder::seek(int frame) {
+    QMutexLocker locker(&mutex);
+    while(!ring.empty() && ring.front().number != frame)
+        ring.pop_front();
+    if(ring.empty()) {
+        seekTarget = frame;
+        generation++;
+    }
+    notFull.wakeAll();
+}
+
+// Readers can't go back or be copied. Instead of dropping the current one
+// on a seek it is parked, and a later seek resumes from the closest parked
+// reader that isn't past the target.
+void AnimationDecoder::run() {
+    struct Cursor {
+        std::unique_ptr<QImageReader> reader;
+        // frame the reader returns next
+        int next;
+    };
+    auto open = [&]() {
+        return Cursor{ std::unique_ptr<QImageReader>(new QImageReader(fileName, format)), 0 };
+    };
+    Cursor cursor = open();
+    std::vector<Cursor> parked;
+    auto resumeAt = [&](int target) {
+        int best = -1;
+        int bestNext = (cursor.next <= target) ? cursor.next : -1;
+        for(int i = 0; i < static_cast<int>(parked.size()); i++) {
+            if(parked[i].next <= target && parked[i].next > bestNext) {
+                best = i;
+                bestNext = parked[i].next;
+            }
+        }
+        if(best != -1) {
+            std::swap(cursor, parked[best]);
+            return;
+        }
+        if(bestNext != -1)
+            return;
+        // a reader at the end is of no use to anyone
+        if(mFrameCount > 0 && cursor.next >= mFrameCount) {
+            cursor = open();
+            return;
+        }
+        // nothing usable, start over; a fresh reader is cheap to get again so
+        // the one parked closest to the start makes room
+        if(static_cast<int>(parked.size()) < PARKED_READERS) {
+            parked.push_back(std::move(cursor));
+        } else {
+            auto lowest = std::min_element(parked.begin(), parked.end(), [](const Cursor &a, const Cursor &b) {
+                return a.next < b.next;
+            });
+            *lowest = std::move(cursor);
+        }
+        cursor = open();
+    };
+    FrameIndex index(mFrameSize, INDEX_MEMORY);
+    // frame to put into the ring next
+    int position = 0;
+    QMutexLocker locker(&mutex);
+    while(!stopRequested) {
+        if(seekTarget == -1 && static_cast<int>(ring.size()) >= capacity) {
+            notFull.wait(&mutex);
+            continue;
+        }
+        bool seeking = (seekTarget != -1);
+        if(seeking)
+            position = seekTarget;
+        seekTarget = -1;
+        // only spend time compressing in-between frames while ahead of playback
+        bool ahead = static_cast<int>(ring.size()) >= 2;
+        uint gen = generation;
+        QSize size = targetSize;
+        Qt::TransformationMode mode = transformMode;
+        locker.unlock();
+
+        AnimationFrame frame;
+        frame.number = position;
+        index.setFocus(position);
+        if(!index.restore(position, frame.image, frame.delay)) {
+            if(position != cursor.next)
+                resumeAt(position);
+            // frames can depend on the previous ones, no way around reading them
+            while(cursor.next <= position) {
+                frame.image = cursor.reader->read();
+                frame.delay = cursor.reader->nextImageDelay();
+                if(frame.image.isNull())
+                    break;
+                // frames read on the way to a seek target are likely to be stepped through
+                index.store(cursor.next++, frame.image, frame.delay, seeking || ahead);
+            }
+        }
+        if(frame.image.isNull()) {
+            locker.relock();
+            if(position == 0) {
+                qDebug() << "[AnimationDecoder]" << cursor.reader->errorString();
+                break;
+            }
+            // ran out before imageCount(), or the count is unknown
+            cursor = open();
+            position = 0;
+            continue;
+        }
+        position = frame.number + 1;
+        if(mFrameCount > 0 && position >= mFrameCount)
+            position = 0;
+        if(size.isValid() && size != frame.image.size())
+            frame.scaled = frame.image.scaled(size, Qt::IgnoreAspectRatio, mode);
+
+        locker.relock();
+        if(gen != generation)
+            continue;
+        bool wasEmpty = ring.empty();
+        ring.push_back(std::move(frame));
+        if(wasEmpty)
+            emit frameReady();
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QImageReader>
+#include <QImage>
+#include <QDebug>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "frameindex.h"
+
+struct AnimationFrame {
+    QImage image;
+    // image scaled to the target size at decode time; null if not needed
+    QImage scaled;
+    int number = 0;
+    int delay = 0;
+};
+
+/* Decodes an animation ahead of the playhead on its own thread.
+ *
+ * Frames go into a small ring, bounded by both count and memory. When a
+ * target size is set, each frame also gets a scaled copy so the gui thread
+ * doesn't have to transform it at paint time. Frames scaled for an older
+ * target still carry the original image.
+ * After the last frame the decoder loops back to the first one.
+ * Decoded frames also go into a FrameIndex, so seeking back restores a
+ * stored frame instead of decoding again. Frames that aren't stored are
+ * decoded from the closest parked reader before them.
+ */
+
+class AnimationDecoder : public QThread {
+    Q_OBJECT
+public:
+    // _frameCount can be 0 if unknown
+    AnimationDecoder(QString _fileName, QByteArray _format, int _frameCount, QSize _frameSize, QObject *parent = nullptr);
+    ~AnimationDecoder();
+    bool isValid() const;
+    int frameCount() const;
+    QSize frameSize() const;
+    // invalid size: no scaled copies
+    void setTargetSize(QSize size, Qt::TransformationMode mode);
+    // false if no frame is ready yet; the delay is the one to play it with
+    bool takeFrame(AnimationFrame &frame);
+    bool hasFrames() const;
+    // makes frame the next one returned by takeFrame()
+    void seek(int frame);
+    // near zero delays are played at a normal pace, like browsers do
+    static int playbackDelay(int delay);
+
+signals:
+    // the ring was empty and got a frame
+    void frameReady();
+
+protected:
+    void run();
+
+private:
+    QString fileName;
+    QByteArray format;
+    int mFrameCount;
+    QSize mFrameSize;
+    int capacity;
+
+    mutable QMutex mutex;
+    QWaitCondition notFull;
+    std::deque<AnimationFrame> ring;
+    QSize targetSize;
+    Qt::TransformationMode transformMode;
+    // -1 if none
+    int seekTarget;
+    // bumped on seek; frames decoded before that are dropped
+    uint generation;
+    bool stopRequested;
+
+    const int MAX_FRAMES = 8;
+    const qint64 MAX_MEMORY = 64 * 1024 * 1024;
+    const qint64 INDEX_MEMORY = 128 * 1024 * 1024;
+    // besides the active one; each holds a frame sized canvas
+    const int PARKED_READERS = 3;
+};
@@ -0,0 +1,108 @@
+#include "frameindex.h"
+
+// Large frames start with a longer stride so compressing the snapshots
+// doesn't slow the playback decode down.
+FrameIndex::FrameIndex(QSize frameSize, qint64 _budget)
+    : focus(0),
+      mStride(1),
+      snapshotsUsed(0),
+      framesUsed(0),
+      budget(_budget)
+{
+    qint64 frameBytes = static_cast<qint64>(frameSize.width()) * frameSize.height() * 4;
+    while(mStride < frameBytes / (1024 * 1024))
+        mStride *= 2;
+}
+
+int FrameIndex::stride() const {
+    return mStride;
+}
+
+bool FrameIndex::contains(int number) const {
+    return snapshots.count(number) || frames.count(number);
+}
+
+void FrameIndex::setFocus(int number) {
+    focus = number;
+}
+
+void FrameIndex::store(int number, const QImage &image, int delay, bool fill) {
+    if(contains(number))
+        return;
+    if(number % mStride == 0) {
+        Entry entry = { compress(image), delay };
+        snapshotsUsed += entry.data.size();
+        snapshots[number] = entry;
+        while(snapshotsUsed > budget / 2 && mStride < (1 << 20))
+            thin();
+    } else if(fill) {
+        Entry entry = { compress(image), delay };
+        framesUsed += entry.data.size();
+        frames[number] = entry;
+        evict();
+    }
+}
+
+bool FrameIndex::restore(int number, QImage &image, int &delay) const {
+    auto it = snapshots.find(number);
+    if(it == snapshots.end()) {
+        it = frames.find(number);
+        if(it == frames.end())
+            return false;
+    }
+    image = decompress(it->second.data);
+    delay = it->second.delay;
+    return !image.isNull();
+}
+
+// dropped snapshots stay around as ordinary frames
+void FrameIndex::thin() {
+    mStride *= 2;
+    for(auto it = snapshots.begin(); it != snapshots.end();) {
+        if(it->first % mStride != 0) {
+            snapshotsUsed -= it->second.data.size();
+            framesUsed += it->second.data.size();
+            frames[it->first] = it->second;
+            it = snapshots.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    evict();
+}
+
+// frames are ordered, so the farthest one from the focus is at either end
+void FrameIndex::evict() {
+    while(framesUsed > budget / 2 && !frames.empty()) {
+        auto first = frames.begin();
+        auto last = std::prev(frames.end());
+        auto victim = (focus - first->first > last->first - focus) ? first : last;
+        framesUsed -= victim->second.data.size();
+        frames.erase(victim);
+    }
+}
+
+// zlib at the lowest level; animation frames are mostly flat areas
+QByteArray FrameIndex::compress(const QImage &frame) {
+    // a color table would not survive the round trip
+    QImage image = frame.colorCount() ? frame.convertToFormat(QImage::Format_ARGB32) : frame;
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << image.size() << static_cast<qint32>(image.format()) << static_cast<qint32>(image.bytesPerLine());
+    out << qCompress(image.constBits(), static_cast<int>(image.sizeInBytes()), 1);
+    return data;
+}
+
+QImage FrameIndex::decompress(const QByteArray &data) {
+    QDataStream in(data);
+    QSize size;
+    qint32 format, bytesPerLine;
+    QByteArray bits;
+    in >> size >> format >> bytesPerLine >> bits;
+    bits = qUncompress(bits);
+    QImage image(size, static_cast<QImage::Format>(format));
+    if(image.isNull() || image.bytesPerLine() != bytesPerLine || bits.size() != image.sizeInBytes())
+        return QImage();
+    memcpy(image.bits(), bits.constData(), static_cast<size_t>(bits.size()));
+    return image;
+}
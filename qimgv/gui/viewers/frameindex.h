@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QImage>
+#include <QByteArray>
+#include <QDataStream>
+#include <map>
+#include <iterator>
+
+/* Compressed copies of decoded animation frames, for seeking.
+ *
+ * Every stride-th frame is kept as a snapshot, the caller decides whether
+ * the ones in between are worth compressing. When the snapshots outgrow
+ * half of the memory budget every other one is dropped and the stride
+ * doubles. The other half holds the frames in between, filled in as they
+ * get decoded; once it is full the frames farthest from the focus (the
+ * playhead) go first. An animation that fits is fully indexed after the
+ * first play, and stepping through it never decodes again.
+ * Not thread safe; owned by the decoder thread.
+ */
+
+class FrameIndex {
+public:
+    FrameIndex(QSize frameSize, qint64 _budget);
+    int stride() const;
+    bool contains(int number) const;
+    // frames far from this one are dropped first
+    void setFocus(int number);
+    // fill: also keep it if it's not a snapshot
+    void store(int number, const QImage &image, int delay, bool fill);
+    bool restore(int number, QImage &image, int &delay) const;
+
+private:
+    struct Entry {
+        QByteArray data;
+        int delay;
+    };
+    std::map<int, Entry> snapshots, frames;
+    int focus;
+    int mStride;
+    qint64 snapshotsUsed, framesUsed, budget;
+
+    void thin();
+    void evict();
+    static QByteArray compress(const QImage &frame);
+    static QImage decompress(const QByteArray &data);
+};
@@ -0,0 +1,61 @@
+#include "graphicsimageitem.h"
+
+GraphicsImageItem::GraphicsImageItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent),
+      dpr(1.0),
+      mTransformationMode(Qt::FastTransformation)
+{
+}
+
+// the dpr is kept here; setting it on the image would detach it
+void GraphicsImageItem::setImage(std::shared_ptr<const QImage> _image, qreal _dpr) {
+    prepareGeometryChange();
+    mImage = _image;
+    dpr = _dpr;
+    pixmapFallback = QPixmap();
+    update();
+}
+
+std::shared_ptr<const QImage> GraphicsImageItem::image() const {
+    return mImage;
+}
+
+void GraphicsImageItem::setOffset(qreal x, qreal y) {
+    if(mOffset == QPointF(x, y))
+        return;
+    prepareGeometryChange();
+    mOffset = QPointF(x, y);
+    update();
+}
+
+void GraphicsImageItem::setTransformationMode(Qt::TransformationMode mode) {
+    if(mTransformationMode == mode)
+        return;
+    mTransformationMode = mode;
+    update();
+}
+
+Qt::TransformationMode GraphicsImageItem::transformationMode() const {
+    return mTransformationMode;
+}
+
+QRectF GraphicsImageItem::boundingRect() const {
+    if(!mImage)
+        return QRectF();
+    return QRectF(mOffset, QSizeF(mImage->size()) / dpr);
+}
+
+void GraphicsImageItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(option)
+    Q_UNUSED(widget)
+    if(!mImage || mImage->isNull())
+        return;
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, mTransformationMode == Qt::SmoothTransformation);
+    if(painter->paintEngine() && painter->paintEngine()->type() == QPaintEngine::Raster) {
+        painter->drawImage(boundingRect(), *mImage, QRectF(mImage->rect()));
+        return;
+    }
+    if(pixmapFallback.isNull())
+        pixmapFallback = QPixmap::fromImage(*mImage);
+    painter->drawPixmap(boundingRect(), pixmapFallback, QRectF(pixmapFallback.rect()));
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPaintEngine>
+#include <QImage>
+#include <QPixmap>
+#include <memory>
+
+/* Like QGraphicsPixmapItem, but draws a QImage that it shares with the
+ * cache instead of keeping a QPixmap copy of it.
+ * The raster engine can draw the image as is. Other engines get a pixmap,
+ * converted on the first paint.
+ */
+
+class GraphicsImageItem : public QGraphicsItem {
+public:
+    GraphicsImageItem(QGraphicsItem *parent = nullptr);
+    void setImage(std::shared_ptr<const QImage> _image, qreal _dpr);
+    std::shared_ptr<const QImage> image() const;
+    void setOffset(qreal x, qreal y);
+    void setTransformationMode(Qt::TransformationMode mode);
+    Qt::TransformationMode transformationMode() const;
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    std::shared_ptr<const QImage> mImage;
+    QPixmap pixmapFallback;
+    QPointF mOffset;
+    qreal dpr;
+    Qt::TransformationMode mTransformationMode;
+};
@@ -1,9 +1,8 @@
 #include "imageviewerv2.h"
 
 ImageViewerV2::ImageViewerV2(QWidget *parent) : QGraphicsView(parent),
-    pixmap(nullptr),
+    image(nullptr),
     pixmapScaled(nullptr),
-    movie(nullptr),
     transparencyGridEnabled(false),
     expandImage(false),
     smoothAnimatedImages(true),
@@ -19,6 +18,13 @@ ImageViewerV2::ImageViewerV2(QWidget *parent) : QGraphicsView(parent),
     imageFitMode(FIT_WINDOW),
     imageFitModeDefault(FIT_WINDOW),
     mScalingFilter(QI_FILTER_BILINEAR),
+    currentFrame(0),
+    currentFrameDelay(0),
+    frameDeadline(0),
+    frameUnderrun(false),
+    seekPending(false),
+    droppedFrames(0),
+    lateFrames(0),
     scene(nullptr)
 {
     if(settings->useOpenGL())
@@ -48,11 +54,12 @@ ImageViewerV2::ImageViewerV2(QWidget *parent) : QGraphicsView(parent),
     scaleTimer->setInterval(80);
 
     lastTouchpadScroll.start();
+    playbackClock.start();
 
     zoomThreshold = static_cast<int>(devicePixelRatioF() * 4.);
 
-    pixmapItem.setTransformationMode(Qt::SmoothTransformation);
-    pixmapItem.setScale(1.0f);
+    imageItem.setTransformationMode(Qt::SmoothTransformation);
+    imageItem.setScale(1.0f);
     pixmapItemScaled.setScale(1.0f);
 
     this->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
@@ -61,7 +68,7 @@ ImageViewerV2::ImageViewerV2(QWidget *parent) : QGraphicsView(parent),
     scene = new QGraphicsScene();
     scene->setSceneRect(0,0,200000,200000);
     scene->setBackgroundBrush(QColor(60,60,103));
-    scene->addItem(&pixmapItem);
+    scene->addItem(&imageItem);
     scene->addItem(&pixmapItemScaled);
     pixmapItemScaled.hide();
 
@@ -101,6 +108,7 @@ void ImageViewerV2::readSettings() {
     updateMinScale();
     setScalingFilter(settings->scalingFilter());
     setFitMode(imageFitModeDefault);
+    updateAnimationTargetSize();
 }
 
 void ImageViewerV2::onFullscreenModeChanged(bool mode) {
@@ -117,118 +125,183 @@ void ImageViewerV2::onFullscreenModeChanged(bool mode) {
 }
 
 void ImageViewerV2::startAnimation() {
-    if(movie && movie->frameCount() > 1) {
+    if(decoder && decoder->frameCount() > 1) {
         stopAnimation();
         emit animationPaused(false);
-        //movie->jumpToFrame(0);
-        //emit frameChanged(0);
-        animationTimer->start(movie->nextFrameDelay());
+        frameDeadline = playbackClock.elapsed() + currentFrameDelay;
+        animationTimer->start(currentFrameDelay);
     }
 }
 
 void ImageViewerV2::stopAnimation() {
-    if(movie) {
+    if(decoder) {
         emit animationPaused(true);
         animationTimer->stop();
+        frameUnderrun = false;
     }
 }
 
 void ImageViewerV2::pauseResume() {
-    if(movie) {
-        if(animationTimer->isActive())
+    if(decoder) {
+        if(animationTimer->isActive() || frameUnderrun)
             stopAnimation();
         else
             startAnimation();
     }
 }
 
+// Frames are decoded and scaled ahead by the decoder, this only shows them.
 void ImageViewerV2::onAnimationTimer() {
-    if(!movie)
+    if(!decoder)
         return;
-    if(movie->currentFrameNumber() == movie->frameCount() - 1) {
+    if(currentFrame == decoder->frameCount() - 1 && !loopPlayback) {
         // last frame
-        if(!loopPlayback) {
-            emit animationPaused(true);
-            emit playbackFinished();
-            return;
-        } else {
-            movie->jumpToFrame(0);
-        }
-    } else {
-        if(!movie->jumpToNextFrame()) {
-            qDebug() << "[Error] QMovie:" << movie->lastErrorString();
-            this->stopAnimation();
+        emit animationPaused(true);
+        emit playbackFinished();
+        return;
+    }
+    AnimationFrame frame;
+    if(!decoder->takeFrame(frame)) {
+        // decoder is behind; onDecoderFrameReady() continues from here
+        frameUnderrun = true;
+        lateFrames++;
+        return;
+    }
+    seekPending = false;
+    qint64 now = playbackClock.elapsed();
+    // a whole frame late: skip it rather than play in slow motion
+    while(now - frameDeadline > frame.delay && decoder->hasFrames()) {
+        if(frame.number == decoder->frameCount() - 1 && !loopPlayback)
+            break;
+        frameDeadline += frame.delay;
+        decoder->takeFrame(frame);
+        droppedFrames++;
+    }
+    showFrame(frame);
+    frameDeadline = qMax(frameDeadline + frame.delay, now);
+    animationTimer->start(static_cast<int>(frameDeadline - now));
+}
+
+void ImageViewerV2::onDecoderFrameReady() {
+    // may be queued from a decoder that is already gone
+    if(!decoder || sender() != decoder.get())
+        return;
+    if(seekPending) {
+        AnimationFrame frame;
+        if(!decoder->takeFrame(frame))
             return;
+        seekPending = false;
+        showFrame(frame);
+        if(animationTimer->isActive() || frameUnderrun) {
+            frameUnderrun = false;
+            frameDeadline = playbackClock.elapsed() + frame.delay;
+            animationTimer->start(frame.delay);
         }
+    } else if(frameUnderrun) {
+        frameUnderrun = false;
+        // resume without trying to make up for the stall
+        frameDeadline = playbackClock.elapsed();
+        onAnimationTimer();
     }
-    emit frameChanged(movie->currentFrameNumber());
-    std::unique_ptr<QPixmap> newFrame(new QPixmap());
-    *newFrame = movie->currentPixmap();
-    updatePixmap(std::move(newFrame));
-    animationTimer->start(movie->nextFrameDelay());
 }
 
 void ImageViewerV2::nextFrame() {
-    if(!movie || movie->currentFrameNumber() == movie->frameCount() - 1)
+    if(!decoder || currentFrame == decoder->frameCount() - 1)
         return;
-    showAnimationFrame(movie->currentFrameNumber() + 1);
+    showAnimationFrame(currentFrame + 1);
 }
 
 void ImageViewerV2::prevFrame() {
-    if(!movie || movie->currentFrameNumber() == 0)
+    if(!decoder || currentFrame == 0)
         return;
-    showAnimationFrame(movie->currentFrameNumber() - 1);
+    showAnimationFrame(currentFrame - 1);
 }
 
+// shows the frame once the decoder gets to it
 bool ImageViewerV2::showAnimationFrame(int frame) {
-    if(!movie || frame < 0 || frame >= movie->frameCount())
+    if(!decoder || frame < 0 || frame >= decoder->frameCount())
         return false;
-    if(movie->currentFrameNumber() == frame)
+    if(currentFrame == frame)
         return true;
-    // at the first glance this may seem retarded
-    // because it is
-    // unfortunately i dont see a *better* way to do seeking with QMovie
-    // QMovie::CacheAll is buggy and memory inefficient
-    if(frame < movie->currentFrameNumber())
-        movie->jumpToFrame(0);
-    while(frame != movie->currentFrameNumber()) {
-        if(!movie->jumpToNextFrame()) {
-            qDebug() << "[Error] QMovie:" << movie->lastErrorString();
-            break;
-        }
+    decoder->seek(frame);
+    AnimationFrame newFrame;
+    if(!decoder->takeFrame(newFrame)) {
+        seekPending = true;
+        return true;
+    }
+    seekPending = false;
+    showFrame(newFrame);
+    if(animationTimer->isActive()) {
+        frameDeadline = playbackClock.elapsed() + newFrame.delay;
+        animationTimer->start(newFrame.delay);
     }
-    emit frameChanged(movie->currentFrameNumber());
-    std::unique_ptr<QPixmap> newFrame(new QPixmap());
-    *newFrame = movie->currentPixmap();
-    updatePixmap(std::move(newFrame));
     return true;
 }
 
-void ImageViewerV2::updatePixmap(std::unique_ptr<QPixmap> newPixmap) {
-    pixmap = std::move(newPixmap);
-    pixmap->setDevicePixelRatio(dpr);
-    pixmapItem.setPixmap(*pixmap);
-    pixmapItem.show();
+// uses the pre-scaled copy if it matches the current zoom
+void ImageViewerV2::showFrame(const AnimationFrame &frame) {
+    currentFrame = frame.number;
+    currentFrameDelay = frame.delay;
+    if(animation)
+        animation->setCurrentFrame(frame.number, frame.image);
+    emit frameChanged(frame.number);
+    updateImage(std::make_shared<const QImage>(frame.image));
+    if(!frame.scaled.isNull() && frame.scaled.size() == scaledSize() * dpr) {
+        setScaledPixmap(std::unique_ptr<QPixmap>(new QPixmap(QPixmap::fromImage(frame.scaled))));
+        return;
+    }
+    if(pixmapItemScaled.isVisible()) {
+        pixmapItemScaled.hide();
+        pixmapItemScaled.setPixmap(QPixmap());
+        pixmapScaled.reset(nullptr);
+    }
+}
+
+// Only smooth scaling is worth doing ahead; fast scaling is free in the scene.
+void ImageViewerV2::updateAnimationTargetSize() {
+    if(!decoder)
+        return;
+    Qt::TransformationMode mode = selectTransformationMode();
+    if(mode == Qt::SmoothTransformation && imageItem.scale() != 1.0f)
+        decoder->setTargetSize(scaledSize() * dpr, mode);
+    else
+        decoder->setTargetSize(QSize(), mode);
+}
+
+void ImageViewerV2::updateImage(std::shared_ptr<const QImage> newImage) {
+    image = newImage;
+    imageItem.setImage(image, dpr);
+    imageItem.show();
     // always scale from center
-    pixmapItem.setOffset((scene->width()  / 2.0) - (pixmap->width()  / (dpr * 2.0)),
-                         (scene->height() / 2.0) - (pixmap->height() / (dpr * 2.0)));
+    imageItem.setOffset((scene->width()  / 2.0) - (image->width()  / (dpr * 2.0)),
+                        (scene->height() / 2.0) - (image->height() / (dpr * 2.0)));
     // always scale from center
-    pixmapItem.setTransformOriginPoint(pixmapItem.boundingRect().center());
-    pixmapItem.update();
+    imageItem.setTransformOriginPoint(imageItem.boundingRect().center());
+    imageItem.update();
 }
 
-void ImageViewerV2::displayAnimation(std::unique_ptr<QMovie> _movie) {
-    if(_movie && _movie->isValid()) {
+// the first frame comes from the image, the rest from the decoder thread
+void ImageViewerV2::displayAnimation(std::shared_ptr<ImageAnimated> _animation) {
+    if(_animation && !_animation->firstFrame()->isNull()) {
         reset();
-        movie = std::move(_movie);
-        movie->jumpToFrame(0);
+        decoder.reset(new AnimationDecoder(_animation->path(), _animation->format(),
+                                           _animation->frameCount(), _animation->size()));
+        if(!decoder->isValid()) {
+            decoder.reset(nullptr);
+            return;
+        }
+        animation = _animation;
+        connect(decoder.get(), &AnimationDecoder::frameReady, this, &ImageViewerV2::onDecoderFrameReady);
+        // first frame is already decoded, start from the second one
+        decoder->seek(1);
+        decoder->start();
         Qt::TransformationMode mode = smoothAnimatedImages ? Qt::SmoothTransformation : Qt::FastTransformation;
-        pixmapItem.setTransformationMode(mode);
-        std::unique_ptr<QPixmap> newFrame(new QPixmap());
-        *newFrame = movie->currentPixmap();
-        updatePixmap(std::move(newFrame));
-        emit durationChanged(movie->frameCount());
-        emit frameChanged(0);
+        imageItem.setTransformationMode(mode);
+        AnimationFrame frame;
+        frame.image = *animation->firstFrame();
+        frame.delay = AnimationDecoder::playbackDelay(animation->firstFrameDelay());
+        showFrame(frame);
+        emit durationChanged(decoder->frameCount());
 
         updateMinScale();
         if(!keepFitMode)
@@ -237,6 +310,8 @@ void ImageViewerV2::displayAnimation(std::unique_ptr<QMovie> _movie) {
             imageFitMode = FIT_WINDOW;
         applyFitMode();
 
+        updateAnimationTargetSize();
+
         if(transparencyGridEnabled)
             drawTransparencyGrid();
 
@@ -245,26 +320,26 @@ void ImageViewerV2::displayAnimation(std::unique_ptr<QMovie> _movie) {
 }
 
 // display & initialize
-void ImageViewerV2::displayImage(std::unique_ptr<QPixmap> _pixmap) {
+// the image is shared with the cache, nothing is copied here
+void ImageViewerV2::displayImage(std::shared_ptr<const QImage> _image) {
     reset();
-    if(_pixmap) {
+    if(_image) {
         pixmapItemScaled.hide();
 
-        pixmap = std::move(_pixmap);
-        pixmap->setDevicePixelRatio(dpr);
-        pixmapItem.setPixmap(*pixmap);
+        image = _image;
+        imageItem.setImage(image, dpr);
 
         Qt::TransformationMode mode = Qt::SmoothTransformation;
         if(mScalingFilter == QI_FILTER_NEAREST)
             mode = Qt::FastTransformation;
-        pixmapItem.setTransformationMode(mode);
+        imageItem.setTransformationMode(mode);
 
-        pixmapItem.show();
+        imageItem.show();
 
-        pixmapItem.setOffset((scene->width()  / 2.0) - (pixmap->width()  / (dpr * 2.0)),
-                             (scene->height() / 2.0) - (pixmap->height() / (dpr * 2.0)));
+        imageItem.setOffset((scene->width()  / 2.0) - (image->width()  / (dpr * 2.0)),
+                            (scene->height() / 2.0) - (image->height() / (dpr * 2.0)));
         // always scale from center
-        pixmapItem.setTransformOriginPoint(pixmapItem.boundingRect().center());
+        imageItem.setTransformOriginPoint(imageItem.boundingRect().center());
 
         updateMinScale();
         if(!keepFitMode)
@@ -285,11 +360,22 @@ void ImageViewerV2::reset() {
     stopPosAnimation();
     pixmapItemScaled.setPixmap(QPixmap());
     pixmapScaled.reset(nullptr);
-    pixmapItem.setPixmap(QPixmap());
-    pixmapItem.setScale(1.0f);
-    pixmap.reset();
+    imageItem.setImage(nullptr, dpr);
+    imageItem.setScale(1.0f);
+    image.reset();
     stopAnimation();
-    movie.reset(nullptr);
+    if(droppedFrames || lateFrames)
+        qDebug() << "[ImageViewer] animation: dropped" << droppedFrames << "frames, late" << lateFrames;
+    decoder.reset(nullptr);
+    if(animation)
+        animation->setCurrentFrame(0, QImage());
+    animation.reset();
+    currentFrame = 0;
+    currentFrameDelay = 0;
+    frameUnderrun = false;
+    seekPending = false;
+    droppedFrames = 0;
+    lateFrames = 0;
     centerOn(sceneRect().center());
     // when this view is not in focus this it won't update the background
     // so we force it here
@@ -301,7 +387,7 @@ void ImageViewerV2::closeImage() {
 }
 
 void ImageViewerV2::setScaledPixmap(std::unique_ptr<QPixmap> newFrame) {
-    if(!movie && newFrame->size() != scaledSize() * dpr)
+    if(!decoder && newFrame->size() != scaledSize() * dpr)
         return;
 
     pixmapScaled = std::move(newFrame);
@@ -309,12 +395,12 @@ void ImageViewerV2::setScaledPixmap(std::unique_ptr<QPixmap> newFrame) {
     pixmapItemScaled.setPixmap(*pixmapScaled);
     pixmapItemScaled.setOffset((scene->width()  / 2.0) - (pixmapScaled->width()  / (dpr * 2.0)),
                                (scene->height() / 2.0) - (pixmapScaled->height() / (dpr * 2.0)));
-    pixmapItem.hide();
+    imageItem.hide();
     pixmapItemScaled.show();
 }
 
 bool ImageViewerV2::isDisplaying() const {
-    return (pixmap != nullptr);
+    return (image != nullptr);
 }
 
 void ImageViewerV2::scrollUp() {
@@ -345,14 +431,14 @@ void ImageViewerV2::setScalingFilter(ScalingFilter filter) {
     if(mScalingFilter == filter)
         return;
     mScalingFilter = filter;
-    pixmapItem.setTransformationMode(selectTransformationMode());
+    imageItem.setTransformationMode(selectTransformationMode());
     if(mScalingFilter == QI_FILTER_NEAREST)
         swapToOriginalPixmap();
     requestScaling();
 }
 
 void ImageViewerV2::setLoopPlayback(bool mode) {
-    if(movie && mode && loopPlayback != mode)
+    if(decoder && mode && loopPlayback != mode)
         startAnimation();
     loopPlayback = mode;
 }
@@ -360,7 +446,7 @@ void ImageViewerV2::setLoopPlayback(bool mode) {
 void ImageViewerV2::setFilterNearest() {
     if(mScalingFilter != QI_FILTER_NEAREST) {
         mScalingFilter = QI_FILTER_NEAREST;
-        pixmapItem.setTransformationMode(selectTransformationMode());
+        imageItem.setTransformationMode(selectTransformationMode());
         swapToOriginalPixmap();
         requestScaling();
     }
@@ -369,7 +455,7 @@ void ImageViewerV2::setFilterNearest() {
 void ImageViewerV2::setFilterBilinear() {
     if(mScalingFilter != QI_FILTER_BILINEAR) {
         mScalingFilter = QI_FILTER_BILINEAR;
-        pixmapItem.setTransformationMode(selectTransformationMode());
+        imageItem.setTransformationMode(selectTransformationMode());
         requestScaling();
     }
 }
@@ -379,11 +465,11 @@ Qt::TransformationMode ImageViewerV2::selectTransformationMode() {
     Qt::TransformationMode mode = Qt::SmoothTransformation;
     if(forceFastScale) {
         mode = Qt::FastTransformation;
-    } else if(movie) {
-        if(!smoothAnimatedImages || (pixmapItem.scale() > 1.0f && !smoothUpscaling))
+    } else if(decoder) {
+        if(!smoothAnimatedImages || (imageItem.scale() > 1.0f && !smoothUpscaling))
             mode = Qt::FastTransformation;
     } else {
-        if((pixmapItem.scale() > 1.0f && !smoothUpscaling) || mScalingFilter == QI_FILTER_NEAREST)
+        if((imageItem.scale() > 1.0f && !smoothUpscaling) || mScalingFilter == QI_FILTER_NEAREST)
             mode = Qt::FastTransformation;
     }
     return mode;
@@ -408,7 +494,7 @@ void ImageViewerV2::hide() {
 }
 
 void ImageViewerV2::requestScaling() {
-    if(!pixmap || pixmapItem.scale() == 1.0f || (!smoothUpscaling && pixmapItem.scale() >= 1.0f) || movie)
+    if(!image || imageItem.scale() == 1.0f || (!smoothUpscaling && imageItem.scale() >= 1.0f) || decoder)
         return;
     // request "real" scaling when graphicsscene scaling is insufficient
     // (it uses a single pass bilinear which is sharp but produces artifacts on low zoom levels)
@@ -444,14 +530,14 @@ void ImageViewerV2::drawTransparencyGrid() {
 }
 
 bool ImageViewerV2::imageFits() const {
-    if(!pixmap)
+    if(!image)
         return true;
-    return (pixmap->width()  <= viewport()->width() &&
-            pixmap->height() <= viewport()->height());
+    return (image->width()  <= viewport()->width() &&
+            image->height() <= viewport()->height());
 }
 
 bool ImageViewerV2::scaledImageFits() const {
-    if(!pixmap)
+    if(!image)
         return true;
     QSize sz = scaledSize();
     return (sz.width()  <= viewport()->width() &&
@@ -467,7 +553,7 @@ QWidget *ImageViewerV2::widget() {
 }
 
 bool ImageViewerV2::hasAnimation() const {
-    return (movie != nullptr);
+    return (decoder != nullptr);
 }
 
 //  Right button zooming / dragging logic
@@ -477,7 +563,7 @@ bool ImageViewerV2::hasAnimation() const {
 //  mouseInteraction: tracks which action we are performing since the last mousePressEvent()
 //
 void ImageViewerV2::mousePressEvent(QMouseEvent *event) {
-    if(!pixmap) {
+    if(!image) {
         QWidget::mousePressEvent(event);
         return;
     }
@@ -492,7 +578,7 @@ void ImageViewerV2::mousePressEvent(QMouseEvent *event) {
 
 void ImageViewerV2::mouseMoveEvent(QMouseEvent *event) {
     QWidget::mouseMoveEvent(event);
-    if(!pixmap || mouseInteraction == MouseInteractionState::MOUSE_DRAG || mouseInteraction == MouseInteractionState::MOUSE_WHEEL_ZOOM)
+    if(!image || mouseInteraction == MouseInteractionState::MOUSE_DRAG || mouseInteraction == MouseInteractionState::MOUSE_WHEEL_ZOOM)
         return;
 
     if(event->buttons() & Qt::LeftButton) {
@@ -545,9 +631,9 @@ void ImageViewerV2::mouseReleaseEvent(QMouseEvent *event) {
     unsetCursor();
     if(forceFastScale) {
         forceFastScale = false;
-        pixmapItem.setTransformationMode(selectTransformationMode());
+        imageItem.setTransformationMode(selectTransformationMode());
     }
-    if(!pixmap || mouseInteraction == MouseInteractionState::MOUSE_NONE) {
+    if(!image || mouseInteraction == MouseInteractionState::MOUSE_NONE) {
         QGraphicsView::mouseReleaseEvent(event);
         event->ignore();
     }
@@ -638,14 +724,14 @@ void ImageViewerV2::mouseMoveZoom(QMouseEvent *event) {
     zoomAnchored(newScale);
     centerIfNecessary();
     snapToEdges();
-    if(pixmapItem.scale() == fitWindowScale)
+    if(imageItem.scale() == fitWindowScale)
         imageFitMode = FIT_WINDOW;
 }
 
 // scale at which current image fills the window
 void ImageViewerV2::updateFitWindowScale() {
-    float newMinScaleX = (float) viewport()->width()  * devicePixelRatioF() / pixmap->width();
-    float newMinScaleY = (float) viewport()->height() * devicePixelRatioF() / pixmap->height();
+    float newMinScaleX = (float) viewport()->width()  * devicePixelRatioF() / image->width();
+    float newMinScaleY = (float) viewport()->height() * devicePixelRatioF() / image->height();
     if(newMinScaleX < newMinScaleY) {
         fitWindowScale = newMinScaleX;
     } else {
@@ -657,7 +743,7 @@ void ImageViewerV2::updateFitWindowScale() {
 
 // limit min scale to window size
 void ImageViewerV2::updateMinScale() {
-    if(!pixmap)
+    if(!image)
         return;
     updateFitWindowScale();
     if(imageFits())
@@ -667,9 +753,9 @@ void ImageViewerV2::updateMinScale() {
 }
 
 void ImageViewerV2::fitWidth() {
-    if(!pixmap)
+    if(!image)
         return;
-    float scaleX = (float)viewport()->width() * devicePixelRatioF() / pixmap->width();
+    float scaleX = (float)viewport()->width() * devicePixelRatioF() / image->width();
     if(!expandImage && scaleX > 1.0f)
         scaleX = 1.0f;
     if(scaleX > expandLimit)
@@ -689,7 +775,7 @@ void ImageViewerV2::fitWidth() {
 }
 
 void ImageViewerV2::fitWindow() {
-    if(!pixmap)
+    if(!image)
         return;
     if(imageFits() && !expandImage) {
         fitNormal();
@@ -703,7 +789,7 @@ void ImageViewerV2::fitWindow() {
 }
 
 void ImageViewerV2::fitNormal() {
-    if(!pixmap)
+    if(!image)
         return;
     if(focusIn1to1 == FOCUS_TOP) {
         doZoom(1.0f);
@@ -791,7 +877,7 @@ void ImageViewerV2::resizeEvent(QResizeEvent *event) {
 }
 
 void ImageViewerV2::centerOnPixmap() {
-    centerOn(pixmapItem.boundingRect().center());
+    centerOn(imageItem.boundingRect().center());
 }
 
 void ImageViewerV2::stopPosAnimation() {
@@ -886,16 +972,16 @@ void ImageViewerV2::scrollToY(int y) {
 }
 
 void ImageViewerV2::swapToOriginalPixmap() {
-    if(!pixmap || !pixmapItemScaled.isVisible())
+    if(!image || !pixmapItemScaled.isVisible())
         return;
     pixmapItemScaled.hide();
     pixmapItemScaled.setPixmap(QPixmap());
     pixmapScaled.reset(nullptr);
-    pixmapItem.show();
+    imageItem.show();
 }
 
 void ImageViewerV2::setZoomAnchor(QPoint viewportPos) {
-    zoomAnchor = QPair(pixmapItem.mapFromScene(mapToScene(viewportPos)),
+    zoomAnchor = QPair(imageItem.mapFromScene(mapToScene(viewportPos)),
                        viewportPos);
 }
 
@@ -906,7 +992,7 @@ void ImageViewerV2::zoomAnchored(float newScale) {
         doZoom(newScale);
         // calculate shift to adjust viewport center
         // we do this in viewport coordinates to avoid any rounding errors
-        QPointF diff = zoomAnchor.second - mapFromScene(pixmapItem.mapToScene(zoomAnchor.first));
+        QPointF diff = zoomAnchor.second - mapFromScene(imageItem.mapToScene(zoomAnchor.first));
         centerOn(vportCenter - diff);
         requestScaling();
     }
@@ -919,7 +1005,7 @@ void ImageViewerV2::zoomIn() {
     centerIfNecessary();
     snapToEdges();
     imageFitMode = FIT_FREE;
-    if(pixmapItem.scale() == fitWindowScale)
+    if(imageItem.scale() == fitWindowScale)
         imageFitMode = FIT_WINDOW;
 }
 
@@ -930,12 +1016,12 @@ void ImageViewerV2::zoomOut() {
     centerIfNecessary();
     snapToEdges();
     imageFitMode = FIT_FREE;
-    if(pixmapItem.scale() == fitWindowScale)
+    if(imageItem.scale() == fitWindowScale)
         imageFitMode = FIT_WINDOW;
 }
 
 void ImageViewerV2::centerIfNecessary() {
-    if(!pixmap)
+    if(!image)
         return;
     QSize sz = scaledSize();
     QPointF centerTarget = mapToScene(viewport()->rect()).boundingRect().center();
@@ -975,7 +1061,7 @@ void ImageViewerV2::zoomInCursor() {
         zoomIn();
     }
     imageFitMode = FIT_FREE;
-    if(pixmapItem.scale() == fitWindowScale)
+    if(imageItem.scale() == fitWindowScale)
         imageFitMode = FIT_WINDOW;
     centerIfNecessary();
     snapToEdges();
@@ -989,18 +1075,19 @@ void ImageViewerV2::zoomOutCursor() {
         zoomIn();
     }
     imageFitMode = FIT_FREE;
-    if(pixmapItem.scale() == fitWindowScale)
+    if(imageItem.scale() == fitWindowScale)
         imageFitMode = FIT_WINDOW;
     centerIfNecessary();
     snapToEdges();
 }
 
 void ImageViewerV2::doZoom(float newScale) {
-    if(!pixmap)
+    if(!image)
         return;
-    pixmapItem.setScale(newScale);
-    pixmapItem.setTransformationMode(selectTransformationMode());
+    imageItem.setScale(newScale);
+    imageItem.setTransformationMode(selectTransformationMode());
     swapToOriginalPixmap();
+    updateAnimationTargetSize();
     emit scaleChanged(newScale);
 }
 
@@ -1024,25 +1111,25 @@ QRectF ImageViewerV2::sceneRoundRect(QRectF sceneRect) const {
 
 // size as it appears on screen (rounded)
 QSize ImageViewerV2::scaledSize() const {
-    if(!pixmap)
+    if(!image)
         return QSize(0,0);
-    QRectF pixmapSceneRect = pixmapItem.mapRectToScene(pixmapItem.boundingRect());
+    QRectF pixmapSceneRect = imageItem.mapRectToScene(imageItem.boundingRect());
     return sceneRoundRect(pixmapSceneRect).size().toSize();
 }
 
 // in viewport coords
 QRect ImageViewerV2::scaledRect() const {
-    QRectF pixmapSceneRect = pixmapItem.mapRectToScene(pixmapItem.boundingRect());
+    QRectF pixmapSceneRect = imageItem.mapRectToScene(imageItem.boundingRect());
     return QRect(mapFromScene(pixmapSceneRect.topLeft()),
                  mapFromScene(pixmapSceneRect.bottomRight()));
 }
 
 float ImageViewerV2::currentScale() const {
-    return pixmapItem.scale();
+    return imageItem.scale();
 }
 
 QSize ImageViewerV2::sourceSize() const {
-    if(!pixmap)
+    if(!image)
         return QSize(0,0);
-    return pixmap->size();
+    return image->size();
 }
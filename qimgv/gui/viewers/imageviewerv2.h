@@ -9,12 +9,14 @@
 #include <QWheelEvent>
 #include <QTimeLine>
 #include <QScrollBar>
-#include <QMovie>
 #include <QColor>
 #include <QTimer>
 #include <QDebug>
 #include <memory>
 #include "settings.h"
+#include "animationdecoder.h"
+#include "graphicsimageitem.h"
+#include "sourcecontainers/imageanimated.h"
 
 enum MouseInteractionState {
     MOUSE_NONE,
@@ -35,8 +37,8 @@ public:
     virtual QRect scaledRect() const;
     virtual float currentScale() const;
     virtual QSize sourceSize() const;
-    virtual void displayImage(std::unique_ptr<QPixmap> _pixmap);
-    virtual void displayAnimation(std::unique_ptr<QMovie> _animation);
+    virtual void displayImage(std::shared_ptr<const QImage> _image);
+    virtual void displayAnimation(std::shared_ptr<ImageAnimated> _animation);
     virtual void setScaledPixmap(std::unique_ptr<QPixmap> newFrame);
     virtual bool isDisplaying() const;
 
@@ -102,6 +104,7 @@ protected:
     void showEvent(QShowEvent *event);
 protected slots:
     void onAnimationTimer();
+    void onDecoderFrameReady();
 private slots:
     void requestScaling();
     void scrollToX(int x);
@@ -109,10 +112,12 @@ private slots:
 
 private:
     QGraphicsScene *scene;
-    std::shared_ptr<QPixmap> pixmap;
+    std::shared_ptr<const QImage> image;
     std::unique_ptr<QPixmap> pixmapScaled;
-    std::unique_ptr<QMovie> movie;
-    QGraphicsPixmapItem pixmapItem, pixmapItemScaled;
+    std::unique_ptr<AnimationDecoder> decoder;
+    std::shared_ptr<ImageAnimated> animation;
+    GraphicsImageItem imageItem;
+    QGraphicsPixmapItem pixmapItemScaled;
     QTimer *animationTimer, *scaleTimer;
     QPoint mouseMoveStartPos, mousePressPos, drawPos;
     bool transparencyGridEnabled, expandImage, smoothAnimatedImages, smoothUpscaling, forceFastScale, keepFitMode, loopPlayback, mIsFullscreen;
@@ -133,6 +138,16 @@ private:
 
     QElapsedTimer lastTouchpadScroll;
 
+    // animation playback
+    int currentFrame, currentFrameDelay;
+    // when the current frame should be replaced, on playbackClock
+    qint64 frameDeadline;
+    QElapsedTimer playbackClock;
+    // no frame was ready on a timer tick / a seek is waiting for its frame
+    bool frameUnderrun, seekPending;
+    // playback stats: frames skipped to catch up / timer ticks with no frame ready
+    int droppedFrames, lateFrames;
+
     ImageFitMode imageFitMode, imageFitModeDefault;
     ImageFocusPoint focusIn1to1;
     ScalingFilter mScalingFilter;
@@ -158,7 +173,9 @@ private:
     void doZoom(float newScale);
     void swapToOriginalPixmap();
     void setZoomAnchor(QPoint viewportPos);
-    void updatePixmap(std::unique_ptr<QPixmap> newPixmap);
+    void updateImage(std::shared_ptr<const QImage> newImage);
+    void showFrame(const AnimationFrame &frame);
+    void updateAnimationTargetSize();
     bool scaledImageFits() const;
     Qt::TransformationMode selectTransformationMode();
     void centerIfNecessary();
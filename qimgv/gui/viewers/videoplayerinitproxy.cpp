@@ -1,16 +1,5 @@
 #include "videoplayerinitproxy.h"
 
-#ifdef _QIMGV_PLAYER_PLUGIN
-    #define QIMGV_PLAYER_PLUGIN _QIMGV_PLAYER_PLUGIN
-#else
-    #define QIMGV_PLAYER_PLUGIN ""
-#endif
-#ifdef _QIMGV_PLUGIN_DIR
-    #define QIMGV_PLUGIN_DIR _QIMGV_PLUGIN_DIR
-#else
-    #define QIMGV_PLUGIN_DIR ""
-#endif
-
 VideoPlayerInitProxy::VideoPlayerInitProxy(QWidget *parent)
     : VideoPlayer(parent),
       player(nullptr)
@@ -43,28 +32,10 @@ inline bool VideoPlayerInitProxy::initPlayer() {
     if(player)
         return true;
 
-    QString libDir  = QIMGV_PLUGIN_DIR;
-    QString libFile = QIMGV_PLAYER_PLUGIN;
-
-// search lib location
-    QStringList searchDirs;
-#ifdef _WIN32
-    searchDirs << libDir << "";
-#else
-    searchDirs << libDir << "/usr/lib/qimgv" << "/usr/lib64/qimgv";
-#endif
-    QFileInfo pluginFile;
-    for(auto dir : searchDirs) {
-        pluginFile.setFile(dir + "/" + libFile);
-        if(pluginFile.isFile() && pluginFile.isReadable()) {
-            playerLib.setFileName(pluginFile.absoluteFilePath());
-            break;
-        }
-    }
-    if(playerLib.fileName().isEmpty()) {
-        qDebug() << "Could not find" << libFile << "in the following directories:" << searchDirs;
+    QString pluginPath = playerPluginPath();
+    if(pluginPath.isEmpty())
         return false;
-    }
+    playerLib.setFileName(pluginPath);
 
 // load lib
     typedef VideoPlayer* (*createPlayerWidgetFn)();
@@ -6,6 +6,7 @@
 #include <QVBoxLayout>
 #include "videoplayer.h"
 #include "settings.h"
+#include "utils/stuff.h"
 #include <QLibrary>
 #include <QFileInfo>
 #include <QDebug>
@@ -212,23 +212,23 @@ std::shared_ptr<ThumbnailStrip> ViewerWidget::getThumbPanel() {
     return mainPanel->getThumbnailStrip();
 }
 
-bool ViewerWidget::showImage(std::unique_ptr<QPixmap> pixmap) {
-    if(!pixmap)
+bool ViewerWidget::showImage(std::shared_ptr<const QImage> image) {
+    if(!image)
         return false;
     stopPlayback();
     videoControls->hide();
     enableImageViewer();
-    imageViewer->displayImage(std::move(pixmap));
+    imageViewer->displayImage(image);
     hideCursorTimed(false);
     return true;
 }
 
-bool ViewerWidget::showAnimation(std::unique_ptr<QMovie> movie) {
-    if(!movie)
+bool ViewerWidget::showAnimation(std::shared_ptr<ImageAnimated> animation) {
+    if(!animation)
         return false;
     stopPlayback();
     enableImageViewer();
-    imageViewer->displayAnimation(std::move(movie));
+    imageViewer->displayAnimation(animation);
     hideCursorTimed(false);
     return true;
 }
@@ -30,8 +30,8 @@ public:
 
     std::shared_ptr<ThumbnailStrip> getThumbPanel();
 
-    bool showImage(std::unique_ptr<QPixmap> pixmap);
-    bool showAnimation(std::unique_ptr<QMovie> movie);
+    bool showImage(std::shared_ptr<const QImage> image);
+    bool showAnimation(std::shared_ptr<ImageAnimated> animation);
     void onScalingFinished(std::unique_ptr<QPixmap> scaled);
     bool isDisplaying();
     ScalingFilter scalingFilter();
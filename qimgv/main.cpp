@@ -6,6 +6,8 @@
 #include "utils/actions.h"
 #include "utils/helprunner.h"
 #include "sharedresources.h"
+#include "components/scheduler/taskscheduler.h"
+#include "components/scheduler/ioscheduler.h"
 #include "proxystyle.h"
 #include "core.h"
 
@@ -80,6 +82,8 @@ int main(int argc, char *argv[]) {
     scriptManager = ScriptManager::getInstance();
     actionManager = ActionManager::getInstance();
     shrRes = SharedResources::getInstance();
+    taskScheduler = TaskScheduler::getInstance();
+    ioScheduler = IoScheduler::getInstance();
 
     atexit(saveSettings);
 
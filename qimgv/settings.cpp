@@ -535,6 +535,14 @@ void Settings::setSquareThumbnails(bool mode) {
     settings->s->setValue("squareThumbnails", mode);
 }
 //------------------------------------------------------------------------------
+bool Settings::recursiveListing() {
+    return settings->s->value("recursiveListing", false).toBool();
+}
+
+void Settings::setRecursiveListing(bool mode) {
+    settings->s->setValue("recursiveListing", mode);
+}
+//------------------------------------------------------------------------------
 bool Settings::transparencyGrid() {
     return settings->s->value("drawTransparencyGrid", false).toBool();
 }
@@ -559,6 +567,18 @@ void Settings::setUseThumbnailCache(bool mode) {
     settings->s->setValue("thumbnailCache", mode);
 }
 //------------------------------------------------------------------------------
+// in MB, 0 disables it
+int Settings::compressedCacheSize() {
+    int size = settings->s->value("compressedCacheSize", 512).toInt();
+    if(size < 0)
+        size = 0;
+    return size;
+}
+
+void Settings::setCompressedCacheSize(int size) {
+    settings->s->setValue("compressedCacheSize", size);
+}
+//------------------------------------------------------------------------------
 QStringList Settings::savedPaths() {
     return settings->state->value("savedPaths").toStringList();
 }
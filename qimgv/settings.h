@@ -137,6 +137,8 @@ public:
     void setMouseWrapping(bool mode);
     bool squareThumbnails();
     void setSquareThumbnails(bool mode);
+    bool recursiveListing();
+    void setRecursiveListing(bool mode);
     bool drawThumbnailSelectionBorder();
     void setDrawThumbnailSelectionBorder(bool mode);
     bool transparencyGrid();
@@ -145,6 +147,8 @@ public:
     void setEnableSmoothScroll(bool mode);
     bool useThumbnailCache();
     void setUseThumbnailCache(bool mode);
+    int compressedCacheSize();
+    void setCompressedCacheSize(int size);
     QStringList savedPaths();
     void setSavedPaths(QStringList paths);
     QString tmpDir();
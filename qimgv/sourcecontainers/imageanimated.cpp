@@ -1,10 +1,11 @@
 #include "imageanimated.h"
 #include <time.h>
 
-// TODO: this class is kinda useless now. redesign?
-
 ImageAnimated::ImageAnimated(QString _path)
-    : Image(_path)
+    : Image(_path),
+      mFrameCount(0),
+      mFirstFrameDelay(0),
+      mCurrentFrame(0)
 {
     mSize.setWidth(0);
     mSize.setHeight(0);
@@ -12,7 +13,10 @@ ImageAnimated::ImageAnimated(QString _path)
 }
 
 ImageAnimated::ImageAnimated(std::unique_ptr<DocumentInfo> _info)
-    : Image(std::move(_info))
+    : Image(std::move(_info)),
+      mFrameCount(0),
+      mFirstFrameDelay(0),
+      mCurrentFrame(0)
 {
     mSize.setWidth(0);
     mSize.setHeight(0);
@@ -25,17 +29,19 @@ ImageAnimated::~ImageAnimated() {
 void ImageAnimated::load() {
     if(isLoaded())
         return;
-    loadMovie();
+    QImageReader reader(mPath, format());
+    mFrameCount = reader.imageCount();
+    QImage *frame = new QImage(reader.read());
+    if(frame->isNull())
+        qDebug() << "[ImageAnimated]" << reader.errorString();
+    mFirstFrameDelay = reader.nextImageDelay();
+    mSize = frame->size();
+    mFirstFrame.reset(frame);
     mLoaded = true;
 }
 
-void ImageAnimated::loadMovie() {
-    movie.reset(new QMovie());
-    movie->setFileName(mPath);
-    movie->setFormat(mDocInfo->format().toStdString().c_str());
-    movie->jumpToFrame(0);
-    mSize = movie->frameRect().size();
-    mFrameCount = movie->frameCount();
+QByteArray ImageAnimated::format() const {
+    return mDocInfo->format().toLatin1();
 }
 
 int ImageAnimated::frameCount() {
@@ -69,18 +75,33 @@ bool ImageAnimated::save() {
 
 // in case of gif returns current frame
 std::unique_ptr<QPixmap> ImageAnimated::getPixmap() {
-    return std::unique_ptr<QPixmap>(new QPixmap(mPath, mDocInfo->format().toStdString().c_str()));
+    return std::unique_ptr<QPixmap>(new QPixmap(QPixmap::fromImage(*getImage())));
 }
 
 std::shared_ptr<const QImage> ImageAnimated::getImage() {
-    std::shared_ptr<const QImage> img(new QImage(mPath, mDocInfo->format().toStdString().c_str()));
-    return img;
+    QMutexLocker locker(&mutex);
+    if(mCurrentFrame == 0 || mCurrentImage.isNull())
+        return mFirstFrame;
+    return std::make_shared<const QImage>(mCurrentImage);
+}
+
+std::shared_ptr<const QImage> ImageAnimated::firstFrame() {
+    return mFirstFrame;
+}
+
+int ImageAnimated::firstFrameDelay() {
+    return mFirstFrameDelay;
+}
+
+int ImageAnimated::currentFrame() {
+    return mCurrentFrame;
 }
 
-std::unique_ptr<QMovie> ImageAnimated::getMovie() {
-    if(movie == nullptr)
-        loadMovie();
-    return std::move(movie);
+// QImage is implicitly shared, so this only takes a reference
+void ImageAnimated::setCurrentFrame(int frame, const QImage &image) {
+    QMutexLocker locker(&mutex);
+    mCurrentFrame = frame;
+    mCurrentImage = (frame == 0) ? QImage() : image;
 }
 
 int ImageAnimated::height() {
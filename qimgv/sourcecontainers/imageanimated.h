@@ -1,8 +1,14 @@
 #pragma once
 
 #include "image.h"
-#include <QMovie>
-#include <QTimer>
+#include <QImageReader>
+#include <QMutex>
+#include <atomic>
+
+/* Keeps the decoded first frame, and the current one while the viewer
+ * plays the animation, so that scaling, clipboard and drag-out don't have
+ * to read the file again. Playback itself goes through AnimationDecoder.
+ */
 
 class ImageAnimated : public Image {
 public:
@@ -12,7 +18,9 @@ public:
 
     std::unique_ptr<QPixmap> getPixmap();
     std::shared_ptr<const QImage> getImage();
-    std::unique_ptr<QMovie> getMovie();
+    std::shared_ptr<const QImage> firstFrame();
+    int firstFrameDelay();
+    QByteArray format() const;
     int height();
     int width();
     QSize size();
@@ -21,17 +29,19 @@ public:
     bool isEdited();
 
     int frameCount();
+    int currentFrame();
+    // called by the viewer for every shown frame
+    void setCurrentFrame(int frame, const QImage &image);
 public slots:
     bool save();
     bool save(QString destPath);
 
-signals:
-    void frameChanged(QPixmap*);
-
 private:
     void load();
     QSize mSize;
-    int mFrameCount;
-    std::unique_ptr<QMovie> movie;
-    void loadMovie();
+    int mFrameCount, mFirstFrameDelay;
+    std::shared_ptr<const QImage> mFirstFrame;
+    std::atomic<int> mCurrentFrame;
+    QImage mCurrentImage;
+    QMutex mutex;
 };
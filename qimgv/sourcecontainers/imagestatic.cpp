@@ -13,6 +13,13 @@ ImageStatic::ImageStatic(std::unique_ptr<DocumentInfo> _info)
     load();
 }
 
+ImageStatic::ImageStatic(std::unique_ptr<DocumentInfo> _info, std::unique_ptr<const QImage> _image)
+    : Image(std::move(_info))
+{
+    image = std::move(_image);
+    mLoaded = true;
+}
+
 ImageStatic::~ImageStatic() {
 }
 
@@ -39,19 +46,14 @@ void ImageStatic::loadGeneric() {
      */
     QImageReader r(mPath, mDocInfo->format().toStdString().c_str());
     QImage *tmp = new QImage();
+    // most handlers decode into the passed image if its size and format fit
+    if(r.size().isValid())
+        *tmp = BufferPool::image(r.size(), r.imageFormat());
     r.read(tmp);
     std::unique_ptr<const QImage> img(tmp);
     img = ImageLib::exifRotated(std::move(img), mDocInfo.get()->exifOrientation());
-    // scaling this format via qt results in transparent background
-    // it rare enough so lets just convert it to the closest working thing
-    if(img->format() == QImage::Format_Mono) {
-        QImage *imgConverted = new QImage();
-        *imgConverted = img->convertToFormat(QImage::Format_Grayscale8);
-        image.reset(imgConverted);
-    } else {
-        // set image
-        image = std::move(img);
-    }
+    // decoders mostly give 32 bit images; keep it smaller while cached
+    image = ImageLib::compacted(std::move(img));
     mLoaded = true;
 }
 
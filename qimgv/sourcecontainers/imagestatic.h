@@ -13,6 +13,8 @@ class ImageStatic : public Image {
 public:
     ImageStatic(QString _path);
     ImageStatic(std::unique_ptr<DocumentInfo> _info);
+    // for already decoded images
+    ImageStatic(std::unique_ptr<DocumentInfo> _info, std::unique_ptr<const QImage> _image);
     ~ImageStatic();
 
     std::unique_ptr<QPixmap> getPixmap();
@@ -0,0 +1,74 @@
+#include "bufferpool.h"
+
+QMutex BufferPool::mutex;
+QList<BufferPool::Buffer*> BufferPool::idle;
+qint64 BufferPool::idleBytes = 0;
+
+QImage BufferPool::image(QSize size, QImage::Format format) {
+    if(size.isEmpty() || format == QImage::Format_Invalid)
+        return QImage();
+    int depth = QImage::toPixelFormat(format).bitsPerPixel();
+    qint64 bytesPerLine = ((static_cast<qint64>(size.width()) * depth + 31) >> 5) << 2;
+    qint64 bytes = bytesPerLine * size.height();
+    if(bytes < MIN_POOLED_SIZE || bytesPerLine > INT_MAX)
+        return QImage(size, format);
+
+    qint64 capacity = sizeClass(bytes);
+    Buffer *buffer = nullptr;
+    mutex.lock();
+    for(int i = 0; i < idle.count(); i++) {
+        if(idle.at(i)->size == capacity) {
+            buffer = idle.takeAt(i);
+            idleBytes -= capacity;
+            break;
+        }
+    }
+    mutex.unlock();
+    if(!buffer) {
+        uchar *data = static_cast<uchar*>(malloc(static_cast<size_t>(capacity)));
+        if(!data)
+            return QImage();
+        buffer = new Buffer{ data, capacity };
+    }
+    return QImage(buffer->data, size.width(), size.height(), static_cast<int>(bytesPerLine),
+                  format, &BufferPool::recycle, buffer);
+}
+
+// called by QImage from whichever thread drops the last reference
+void BufferPool::recycle(void *info) {
+    Buffer *buffer = static_cast<Buffer*>(info);
+    QList<Buffer*> freed;
+    mutex.lock();
+    idle.append(buffer);
+    idleBytes += buffer->size;
+    while(idleBytes > MAX_IDLE_SIZE) {
+        freed.append(idle.takeFirst());
+        idleBytes -= freed.last()->size;
+    }
+    mutex.unlock();
+    for(auto freedBuffer : freed) {
+        free(freedBuffer->data);
+        delete freedBuffer;
+    }
+}
+
+void BufferPool::trim() {
+    mutex.lock();
+    QList<Buffer*> freed;
+    freed.swap(idle);
+    idleBytes = 0;
+    mutex.unlock();
+    for(auto buffer : freed) {
+        free(buffer->data);
+        delete buffer;
+    }
+}
+
+// rounds up to the next 1/8 of the highest power of two below
+qint64 BufferPool::sizeClass(qint64 bytes) {
+    qint64 highest = 1;
+    while(highest <= bytes / 2)
+        highest *= 2;
+    qint64 step = qMax(highest / 8, qint64(1));
+    return (bytes + step - 1) / step * step;
+}
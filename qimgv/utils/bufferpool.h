@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QList>
+#include <cstdlib>
+#include <climits>
+
+/* Recycles large pixel buffers between images.
+ *
+ * Images from image() give their buffer back here once the last copy is
+ * gone, and the next image of the same size class picks it up again. This
+ * avoids mapping and faulting in fresh pages for every decoded photo.
+ * Size classes are 1/8 of a power of two apart. Idle buffers are capped,
+ * the oldest are freed first. Small images are allocated as usual.
+ * Thread safe.
+ */
+
+class BufferPool {
+public:
+    // the buffer is not cleared
+    static QImage image(QSize size, QImage::Format format);
+    // frees all idle buffers
+    static void trim();
+
+private:
+    struct Buffer {
+        uchar *data;
+        qint64 size;
+    };
+    static void recycle(void *info);
+    static qint64 sizeClass(qint64 bytes);
+
+    static QMutex mutex;
+    // oldest first
+    static QList<Buffer*> idle;
+    static qint64 idleBytes;
+
+    static const qint64 MIN_POOLED_SIZE = 1024 * 1024;
+    static const qint64 MAX_IDLE_SIZE = 256 * 1024 * 1024;
+};
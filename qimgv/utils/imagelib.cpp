@@ -25,11 +25,135 @@
 }
 */
 
+// Pixel loops for the 90 degree steps. These write into pooled buffers
+// which QImage::transformed() and mirrored() can't do.
+namespace {
+
+template<int BPP> struct Pixel {
+    uchar bytes[BPP];
+};
+
+template<int BPP>
+void rotate90(const QImage &src, QImage &dest, bool clockwise) {
+    // tiles keep both sides in cache
+    const int TILE = 64;
+    int w = src.width(), h = src.height();
+    // scanLine() detaches, too slow for per pixel use
+    uchar *destBits = dest.bits();
+    qint64 destBytesPerLine = dest.bytesPerLine();
+    for(int ty = 0; ty < h; ty += TILE) {
+        for(int tx = 0; tx < w; tx += TILE) {
+            for(int y = ty; y < qMin(ty + TILE, h); y++) {
+                auto in = reinterpret_cast<const Pixel<BPP>*>(src.constScanLine(y));
+                int destX = clockwise ? h - 1 - y : y;
+                for(int x = tx; x < qMin(tx + TILE, w); x++) {
+                    int destY = clockwise ? x : w - 1 - x;
+                    reinterpret_cast<Pixel<BPP>*>(destBits + destY * destBytesPerLine)[destX] = in[x];
+                }
+            }
+        }
+    }
+}
+
+template<int BPP>
+void mirror(const QImage &src, QImage &dest, bool horizontal, bool vertical) {
+    int w = src.width(), h = src.height();
+    for(int y = 0; y < h; y++) {
+        auto in = reinterpret_cast<const Pixel<BPP>*>(src.constScanLine(y));
+        auto out = reinterpret_cast<Pixel<BPP>*>(dest.scanLine(vertical ? h - 1 - y : y));
+        if(!horizontal) {
+            memcpy(out, in, static_cast<size_t>(w) * BPP);
+            continue;
+        }
+        for(int x = 0; x < w; x++)
+            out[w - 1 - x] = in[x];
+    }
+}
+
+void copyMetadata(const QImage &src, QImage &dest, bool transposed) {
+    dest.setColorTable(src.colorTable());
+    dest.setDotsPerMeterX(transposed ? src.dotsPerMeterY() : src.dotsPerMeterX());
+    dest.setDotsPerMeterY(transposed ? src.dotsPerMeterX() : src.dotsPerMeterY());
+}
+
+// returns a null image for formats that aren't whole bytes per pixel
+QImage mirroredPooled(const QImage *src, bool horizontal, bool vertical) {
+    QImage dest = BufferPool::image(src->size(), src->format());
+    if(dest.isNull())
+        return dest;
+    switch(src->depth()) {
+    case 8:  mirror<1>(*src, dest, horizontal, vertical); break;
+    case 16: mirror<2>(*src, dest, horizontal, vertical); break;
+    case 24: mirror<3>(*src, dest, horizontal, vertical); break;
+    case 32: mirror<4>(*src, dest, horizontal, vertical); break;
+    case 64: mirror<8>(*src, dest, horizontal, vertical); break;
+    default: return QImage();
+    }
+    copyMetadata(*src, dest, false);
+    return dest;
+}
+
+QImage rotated90Pooled(const QImage *src, bool clockwise) {
+    QImage dest = BufferPool::image(src->size().transposed(), src->format());
+    if(dest.isNull())
+        return dest;
+    switch(src->depth()) {
+    case 8:  rotate90<1>(*src, dest, clockwise); break;
+    case 16: rotate90<2>(*src, dest, clockwise); break;
+    case 24: rotate90<3>(*src, dest, clockwise); break;
+    case 32: rotate90<4>(*src, dest, clockwise); break;
+    case 64: rotate90<8>(*src, dest, clockwise); break;
+    default: return QImage();
+    }
+    copyMetadata(*src, dest, true);
+    return dest;
+}
+
+// QImage::scaled() expands the whole source to 32 bit before smooth scaling.
+// For the 8 and 24 bit formats the scale is done in two passes instead:
+// the shrinking axis first, in strips, so only one strip is expanded at a time.
+// Box filtering is separable, the result is the same up to rounding.
+QImage smoothScaledStrips(const QImage &src, QSize destSize) {
+    const qint64 STRIP_BYTES = 4 * 1024 * 1024;
+    QImage::Format format = src.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+    int w = src.width(), h = src.height();
+    // strips are rows when the width shrinks, columns otherwise
+    bool rows = destSize.width() < w;
+    int count = rows ? h : w;
+    int step = qMax(1, static_cast<int>(STRIP_BYTES / (4 * (rows ? w : h))));
+    QImage pass(rows ? QSize(destSize.width(), h) : QSize(w, destSize.height()), format);
+    if(pass.isNull())
+        return pass;
+    for(int i = 0; i < count; i += step) {
+        int n = qMin(step, count - i);
+        QImage strip = src.copy(rows ? QRect(0, i, w, n) : QRect(i, 0, n, h)).convertToFormat(format);
+        if(rows) {
+            strip = strip.scaled(destSize.width(), n, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            for(int y = 0; y < n; y++)
+                memcpy(pass.scanLine(i + y), strip.constScanLine(y), static_cast<size_t>(destSize.width()) * 4);
+        } else {
+            strip = strip.scaled(n, destSize.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            for(int y = 0; y < destSize.height(); y++)
+                memcpy(reinterpret_cast<QRgb*>(pass.scanLine(y)) + i, strip.constScanLine(y), static_cast<size_t>(n) * 4);
+        }
+    }
+    return pass.scaled(destSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+}
+//------------------------------------------------------------------------------
 QImage *ImageLib::rotated(const QImage *src, int grad) {
     QImage *img = new QImage();
-    QTransform transform;
-    transform.rotate(grad);
-    *img = src->transformed(transform, Qt::SmoothTransformation);
+    grad = ((grad % 360) + 360) % 360;
+    if(grad == 90 || grad == 270)
+        *img = rotated90Pooled(src, grad == 90);
+    else if(grad == 180)
+        *img = mirroredPooled(src, true, true);
+    if(img->isNull()) {
+        QTransform transform;
+        transform.rotate(grad);
+        *img = src->transformed(transform, Qt::SmoothTransformation);
+    }
     return img;
 }
 //------------------------------------------------------------------------------
@@ -38,13 +162,20 @@ QImage *ImageLib::rotated(std::shared_ptr<const QImage> src, int grad) {
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::cropped(const QImage *src, QRect newRect) {
-    QImage *img = nullptr;
-    if(src->rect().contains(newRect, false)) {
-        img = new QImage(newRect.size(), src->format());
+    QImage *img = new QImage();
+    if(!src->rect().contains(newRect, false))
+        return img;
+    int bytesPerPixel = src->depth() / 8;
+    if(src->depth() % 8 == 0)
+        *img = BufferPool::image(newRect.size(), src->format());
+    if(img->isNull()) {
         *img = src->copy(newRect);
-    } else {
-        img = new QImage();
+        return img;
     }
+    size_t rowBytes = static_cast<size_t>(newRect.width()) * bytesPerPixel;
+    for(int y = 0; y < newRect.height(); y++)
+        memcpy(img->scanLine(y), src->constScanLine(newRect.y() + y) + newRect.x() * bytesPerPixel, rowBytes);
+    copyMetadata(*src, *img, false);
     return img;
 }
 //------------------------------------------------------------------------------
@@ -53,7 +184,8 @@ QImage* ImageLib::cropped(std::shared_ptr<const QImage> src, QRect newRect) {
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedH(const QImage *src) {
-    return new QImage(src->mirrored(true, false));
+    QImage img = mirroredPooled(src, true, false);
+    return new QImage(img.isNull() ? src->mirrored(true, false) : img);
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedH(std::shared_ptr<const QImage> src) {
@@ -61,7 +193,8 @@ QImage* ImageLib::flippedH(std::shared_ptr<const QImage> src) {
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedV(const QImage *src) {
-    return new QImage(src->mirrored(false, true));
+    QImage img = mirroredPooled(src, false, true);
+    return new QImage(img.isNull() ? src->mirrored(false, true) : img);
 }
 //------------------------------------------------------------------------------
 QImage* ImageLib::flippedV(std::shared_ptr<const QImage> src) {
@@ -132,6 +265,96 @@ std::unique_ptr<QImage> ImageLib::exifRotated(std::unique_ptr<QImage> src, int o
     return src;
 }
 //------------------------------------------------------------------------------
+// Converts to the smallest format that keeps every pixel as is:
+// gray -> Grayscale8, up to 256 colors -> Indexed8, opaque -> RGB888.
+// The raster paint engine expands these only for the spans it paints.
+// The scaler hands Grayscale8 and RGB888 to OpenCV as they are and
+// otherwise expands them a strip at a time, see smoothScaledStrips().
+std::unique_ptr<const QImage> ImageLib::compacted(std::unique_ptr<const QImage> src) {
+    if(!src || src->isNull())
+        return src;
+    QImage::Format format = src->format();
+    // qt scaling makes these transparent
+    if(format == QImage::Format_Mono || format == QImage::Format_MonoLSB)
+        return std::unique_ptr<const QImage>(new QImage(src->convertToFormat(QImage::Format_Grayscale8)));
+    if(format != QImage::Format_RGB32 &&
+       format != QImage::Format_ARGB32 &&
+       format != QImage::Format_ARGB32_Premultiplied)
+    {
+        return src;
+    }
+    bool opaque = true, gray = true;
+    // small open addressing set; colors.size() > 256 means "too many"
+    const int TABLE_SIZE = 1024;
+    QVector<QRgb> colors;
+    std::vector<QRgb> table(TABLE_SIZE);
+    std::vector<bool> used(TABLE_SIZE, false);
+    std::vector<uchar> tableIndex(TABLE_SIZE);
+    for(int y = 0; y < src->height() && (gray || opaque || colors.size() <= 256); y++) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(src->constScanLine(y));
+        for(int x = 0; x < src->width(); x++) {
+            QRgb px = line[x];
+            if(format == QImage::Format_RGB32)
+                px |= 0xff000000;
+            if(qAlpha(px) != 255)
+                opaque = false;
+            if(qRed(px) != qGreen(px) || qGreen(px) != qBlue(px))
+                gray = false;
+            if(colors.size() > 256)
+                continue;
+            uint slot = (px * 2654435761u) >> 22;
+            while(used[slot] && table[slot] != px)
+                slot = (slot + 1) % TABLE_SIZE;
+            if(!used[slot]) {
+                used[slot] = true;
+                table[slot] = px;
+                tableIndex[slot] = static_cast<uchar>(colors.size());
+                colors.append(px);
+            }
+        }
+    }
+    // premultiplied pixels don't round trip through a color table
+    bool indexable = colors.size() <= 256 && (opaque || format == QImage::Format_ARGB32);
+    QImage::Format destFormat;
+    if(gray && opaque)
+        destFormat = QImage::Format_Grayscale8;
+    else if(indexable)
+        destFormat = QImage::Format_Indexed8;
+    else if(opaque)
+        destFormat = QImage::Format_RGB888;
+    else
+        return src;
+    // converted by hand to land in a pooled buffer
+    QImage dest = BufferPool::image(src->size(), destFormat);
+    if(dest.isNull())
+        return src;
+    for(int y = 0; y < src->height(); y++) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(src->constScanLine(y));
+        uchar *out = dest.scanLine(y);
+        for(int x = 0; x < src->width(); x++) {
+            QRgb px = line[x];
+            if(destFormat == QImage::Format_Grayscale8) {
+                out[x] = static_cast<uchar>(qRed(px));
+            } else if(destFormat == QImage::Format_RGB888) {
+                out[x * 3]     = static_cast<uchar>(qRed(px));
+                out[x * 3 + 1] = static_cast<uchar>(qGreen(px));
+                out[x * 3 + 2] = static_cast<uchar>(qBlue(px));
+            } else {
+                if(format == QImage::Format_RGB32)
+                    px |= 0xff000000;
+                uint slot = (px * 2654435761u) >> 22;
+                while(!used[slot] || table[slot] != px)
+                    slot = (slot + 1) % TABLE_SIZE;
+                out[x] = tableIndex[slot];
+            }
+        }
+    }
+    dest.setColorTable(destFormat == QImage::Format_Indexed8 ? colors : QVector<QRgb>());
+    dest.setDotsPerMeterX(src->dotsPerMeterX());
+    dest.setDotsPerMeterY(src->dotsPerMeterY());
+    return std::unique_ptr<const QImage>(new QImage(dest));
+}
+//------------------------------------------------------------------------------
 /*
 
 QImage *ImageLib::cropped(QRect newRect, QRect targetRes, bool upscaled) {
@@ -152,6 +375,15 @@ QImage *ImageLib::cropped(QRect newRect, QRect targetRes, bool upscaled) {
 
 QImage* ImageLib::scaled(std::shared_ptr<const QImage> source, QSize destSize, ScalingFilter filter) {
 #ifdef USE_OPENCV
+    // opencv has no use for a color table
+    if(filter > 1 && source->format() == QImage::Format_Indexed8) {
+        QImage::Format format = QImage::Format_RGB888;
+        if(source->hasAlphaChannel())
+            format = QImage::Format_ARGB32;
+        else if(source->allGray())
+            format = QImage::Format_Grayscale8;
+        source = std::make_shared<const QImage>(source->convertToFormat(format));
+    }
     if(filter > 1 && !QtOcv::isSupported(source->format()))
         filter = QI_FILTER_BILINEAR;
 #endif
@@ -176,7 +408,15 @@ QImage* ImageLib::scaled(std::shared_ptr<const QImage> source, QSize destSize, S
 QImage* ImageLib::scaled_Qt(std::shared_ptr<const QImage> source, QSize destSize, bool smooth) {
     QImage *dest = new QImage();
     Qt::TransformationMode mode = smooth ? Qt::SmoothTransformation : Qt::FastTransformation;
-    *dest = source->scaled(destSize.width(), destSize.height(), Qt::IgnoreAspectRatio, mode);
+    QImage::Format format = source->format();
+    bool compact = format == QImage::Format_Indexed8 ||
+                   format == QImage::Format_Grayscale8 ||
+                   format == QImage::Format_RGB888;
+    // upscaled output is larger than the expanded source anyway
+    if(smooth && compact && (destSize.width() < source->width() || destSize.height() < source->height()))
+        *dest = smoothScaledStrips(*source, destSize);
+    else
+        *dest = source->scaled(destSize.width(), destSize.height(), Qt::IgnoreAspectRatio, mode);
 
 
     return dest;
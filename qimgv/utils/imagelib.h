@@ -8,6 +8,7 @@
 #include <QProcess>
 #include "sourcecontainers/documentinfo.h"
 #include "settings.h"
+#include "utils/bufferpool.h"
 
 #ifdef USE_OPENCV
 #include "3rdparty/QtOpenCV/cvmatandqimage.h"
@@ -39,4 +40,5 @@ class ImageLib {
 #endif
         static std::unique_ptr<const QImage> exifRotated(std::unique_ptr<const QImage> src, int orientation);
         static std::unique_ptr<QImage> exifRotated(std::unique_ptr<QImage> src, int orientation);
+        static std::unique_ptr<const QImage> compacted(std::unique_ptr<const QImage> src);
 };
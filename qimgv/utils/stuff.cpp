@@ -1,4 +1,18 @@
 #include "stuff.h"
+#include <QFileInfo>
+#include <QStringList>
+#include <QDebug>
+
+#ifdef _QIMGV_PLAYER_PLUGIN
+    #define QIMGV_PLAYER_PLUGIN _QIMGV_PLAYER_PLUGIN
+#else
+    #define QIMGV_PLAYER_PLUGIN ""
+#endif
+#ifdef _QIMGV_PLUGIN_DIR
+    #define QIMGV_PLUGIN_DIR _QIMGV_PLUGIN_DIR
+#else
+    #define QIMGV_PLUGIN_DIR ""
+#endif
 
 int clamp(int x, int lower, int upper) {
     return qMin(upper, qMax(x, lower));
@@ -32,3 +46,24 @@ QString fromStdString(StdString str) {
     return QString::fromStdString(str);
 #endif
 }
+
+QString playerPluginPath() {
+    QString libDir  = QIMGV_PLUGIN_DIR;
+    QString libFile = QIMGV_PLAYER_PLUGIN;
+    if(libFile.isEmpty())
+        return "";
+    QStringList searchDirs;
+#ifdef _WIN32
+    searchDirs << libDir << "";
+#else
+    searchDirs << libDir << "/usr/lib/qimgv" << "/usr/lib64/qimgv";
+#endif
+    QFileInfo pluginFile;
+    for(auto dir : searchDirs) {
+        pluginFile.setFile(dir + "/" + libFile);
+        if(pluginFile.isFile() && pluginFile.isReadable())
+            return pluginFile.absoluteFilePath();
+    }
+    qDebug() << "Could not find" << libFile << "in the following directories:" << searchDirs;
+    return "";
+}
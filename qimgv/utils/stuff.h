@@ -14,3 +14,5 @@ int clamp(int x, int lower, int upper);
 int probeOS();
 StdString toStdString(QString str);
 QString fromStdString(StdString str);
+// returns absolute path to the video player plugin, or empty string
+QString playerPluginPath();